@@ -70,9 +70,12 @@ OP_CODE(LOCALSEND_BLOCK)
 OP_CODE(LOCALTAILSEND_BLOCK)
 OP_CODE(MATCHSEND_BLOCK)
 OP_CODE(MATCHTAILSEND_BLOCK)
+OP_CODE(MATCHSEND_BOOL)
+OP_CODE(MATCHTAILSEND_BOOL)
 OP_CODE(SEND_NATIVE)
 OP_CODE(SEND_CONSTANT)
 OP_CODE(SEND_PROPERTY)
+OP_CODE(SEND_ARGUMENT)
 OP_CODE(SEND_PRIMITIVE_CALL_BLOCK)
 OP_CODE(TAILSEND_PRIMITIVE_CALL_BLOCK)
 OP_CODE(SEND_PRIMITIVE_CONS)
@@ -116,3 +119,12 @@ OP_CODE(SEND_PRIMITIVE_STR_LT)
 OP_CODE(SEND_PRIMITIVE_STR_LTE)
 OP_CODE(SEND_PRIMITIVE_STR_GT)
 OP_CODE(SEND_PRIMITIVE_STR_GTE)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_ADD)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_SUB)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_DIV)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_MUL)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_MOD)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_LT)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_LTE)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_GT)
+OP_CODE(CONSTANT_SEND_PRIMITIVE_GTE)
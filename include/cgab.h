@@ -106,10 +106,22 @@
  * hashing strings. It is a tradeoff, because all strings that share that
  * prefix will collide, basically creating a linked-list at that bucket.
  *
- * If this macro is 0, then cgab will not limit hashing.
+ * If this macro is 0, then cgab will not limit hashing. This is the default,
+ * as strings are hashed several bytes at a time and long strings with a common
+ * prefix (paths, urls, log lines) are common.
  */
 #ifndef cGAB_STRING_HASHLEN
-#define cGAB_STRING_HASHLEN 256
+#define cGAB_STRING_HASHLEN 0
+#endif
+
+/*
+ * Strings (and binaries) longer than this many bytes are not interned when
+ * they are created. @see gab_nbigstring
+ *
+ * If this macro is 0, then every string is interned.
+ */
+#ifndef cGAB_STRING_INTERN_MAX
+#define cGAB_STRING_INTERN_MAX 1024
 #endif
 
 /*
@@ -187,6 +199,59 @@
 #define cGAB_DEBUG_GC 0
 #endif
 
+/*
+ * The number of slots in each job's reference-count coalescing cache.
+ *
+ * Before increments and decrements reach the gc buffers, they pass through a
+ * small direct-mapped cache on the job. An increment and a decrement of the
+ * same object within one epoch cancel out, and the collector never sees them.
+ *
+ * This must be a power of 2. The gc buffers keep this many entries in reserve,
+ * so that the cache can always be flushed at the end of an epoch.
+ */
+#ifndef cGAB_GC_RC_CACHE_LEN
+#define cGAB_GC_RC_CACHE_LEN 64
+#endif
+
+#if cGAB_GC_RC_CACHE_LEN & (cGAB_GC_RC_CACHE_LEN - 1)
+#error "cGAB_GC_RC_CACHE_LEN must be a power of 2"
+#endif
+
+/*
+ * The number of objects a job may create in one epoch before it signals a
+ * collection.
+ *
+ * New objects are queued on a growable young list rather than the fixed-size
+ * gc buffers, so without this budget a job which only makes temporaries would
+ * never fill a buffer, and never trigger a collection.
+ */
+#ifndef cGAB_GC_YOUNG_MAX
+#define cGAB_GC_YOUNG_MAX (GAB_GC_MOD_BUFF_MAX * 4)
+#endif
+
+/*
+ * When profiling with fGAB_PROFILE, the minimum time between two samples of a
+ * job's running fiber, in nanoseconds.
+ *
+ * The clock is only read once every cGAB_PROFILE_CHECKS signal checks, so
+ * samples may be taken a little later than this.
+ */
+#ifndef cGAB_PROFILE_INTERVAL_NS
+#define cGAB_PROFILE_INTERVAL_NS 1000000
+#endif
+
+#ifndef cGAB_PROFILE_CHECKS
+#define cGAB_PROFILE_CHECKS 256
+#endif
+
+/*
+ * The deepest stack which the profiler will record. Frames nearest the root
+ * are dropped beyond this.
+ */
+#ifndef cGAB_PROFILE_MAX_DEPTH
+#define cGAB_PROFILE_MAX_DEPTH 128
+#endif
+
 /*
  * Log debug information about object lifetimes and garbage collection to
  * stderr.
@@ -226,6 +291,19 @@
 #define cGAB_LOG_VM 0
 #endif
 
+/*
+ * Count how often each pair and triple of opcodes is dispatched, and write the
+ * counts to stderr when the engine is destroyed.
+ *
+ * Running benchmarks and real workloads with this on shows which sequences are
+ * hot - these are the candidates for new super instructions.
+ *
+ * Like cGAB_LOG_VM, this adds overhead to every bytecode op.
+ */
+#ifndef cGAB_LOG_VM_SEQUENCES
+#define cGAB_LOG_VM_SEQUENCES 0
+#endif
+
 /*
  * Compiler attributes to apply to the vm opcode-handling functions.
  *
@@ -414,6 +492,10 @@
 #error "cGAB_GC_MOD_BUFF_MAX must be greater than to cGAB_STACK_MAX"
 #endif
 
+#if GAB_GC_MOD_BUFF_MAX <= (cGAB_GC_RC_CACHE_LEN * 2)
+#error "GAB_GC_MOD_BUFF_MAX must leave room for the rc cache reserve"
+#endif
+
 /*
  * Maximum number of constants in a module.
  * Constants must be addressable by a uint16_t
@@ -578,6 +660,19 @@ enum gab_status {
 #define tGAB_IOFILE "io\\file"
 #define tGAB_IOSOCK "io\\sock"
 
+/*
+ * The type of the boxes made by Strings.builder.
+ *
+ * Their data is a struct gab_strbuilder, so that other modules may
+ * read the bytes directly instead of asking for a string.
+ */
+#define tGAB_STRBUILDER "string\\builder"
+
+struct gab_strbuilder {
+  uint64_t len, cap;
+  char *data;
+};
+
 /*
  * Builtin messages for ast nodes.
  */
@@ -1314,9 +1409,19 @@ GAB_API_INLINE gab_uint __gab_valtou(gab_value v) {
  * directly.
  *
  * cgab does this in a lot of places.
+ *
+ * This compares *identity*. Two strings which aren't interned (see
+ * gab_nbigstring) may be equal without being identical - use gab_valequal
+ * to compare those the way gab's '==' does.
  */
 #define gab_valeq(a, b) ((a) == (b))
 
+/*
+ * Compare two values the way gab's '==' does. Strings which aren't interned
+ * are compared by their contents, everything else by identity.
+ */
+GAB_API bool gab_valequal(gab_value a, gab_value b);
+
 /*
  * Gab uses a purely RC garbage collection approach.
  *
@@ -1326,9 +1431,6 @@ GAB_API_INLINE gab_uint __gab_valtou(gab_value v) {
 #define fGAB_OBJ_BUFFERED ((uint8_t)1 << 0)
 #define fGAB_OBJ_NEW ((uint8_t)1 << 1)
 
-// TODO @cgab @opt: Lots of bits are wasted in the flags. Use 13-14 bits for rc,
-// and 3-2 for flags.
-
 /*
  * When cGAB_LOG_GC is enabled, instead of actually freeing objects,
  * cgab simply marks them as freed with this flag. Then, if they are used or
@@ -1351,6 +1453,20 @@ GAB_API_INLINE gab_uint __gab_valtou(gab_value v) {
 #define GAB_OBJ_IS_FREED(obj) ((obj)->flags & fGAB_OBJ_FREED)
 #define GAB_OBJ_FREED(obj) ((obj)->flags |= fGAB_OBJ_FREED)
 
+/*
+ * The reference count gets its own 16-bit field, so that it never shares a
+ * byte with flags. Workers write flags (see gab_gcunlock) on objects the gc
+ * may already be counting references to in the same byte otherwise - keeping
+ * the two apart means a flag write can never clobber a count.
+ *
+ * Always go through these macros to read and write the reference count.
+ */
+#define GAB_OBJ_RC_MAX (UINT16_MAX)
+
+#define GAB_OBJ_RC(obj) ((uint16_t)(obj)->references)
+
+#define GAB_OBJ_SETRC(obj, rc) ((obj)->references = (uint16_t)(rc))
+
 /**
  * @class gab_obj
  * @brief This struct is the first member of all heap-allocated objects.
@@ -1361,11 +1477,15 @@ struct gab_obj {
   /**
    * @brief The number of live references to this object.
    *
-   * If this number is overflowed, gab keeps track  of this object's
+   * Interned shapes, messages and shared constants routinely sit above a few
+   * hundred references, which is why this is wider than a byte.
+   *
+   * If GAB_OBJ_RC_MAX is overflowed, gab keeps track  of this object's
    * references in a separate, slower dict<gab_obj, uint64_t>. When the
-   * reference count drops back under 255, rc returns to the fast path.
+   * reference count drops back under GAB_OBJ_RC_MAX, rc returns to the fast
+   * path.
    */
-  uint8_t references;
+  uint16_t references;
 
   /**
    * @brief Flags used by garbage collection and for debug information.
@@ -1373,9 +1493,12 @@ struct gab_obj {
    * These *don't* have to be atomic, even though theoretically they are
    * consumed by the worker *and* gc threads.
    *
-   * This because the worker threads only touch this field on object *creation*,
-   * before the GC knows that the object exists. From that point on though,
-   * this field is owned and modified *exclusively* by the GC thread.
+   * This because the worker threads only touch this field on object
+   * *creation*, before the GC knows that the object exists (gab_gcunlock
+   * clears fGAB_OBJ_BUFFERED just before handing the object over). From that
+   * point on, this field is owned and modified *exclusively* by the GC thread.
+   * The reference count lives in its own field for exactly this reason - see
+   * GAB_OBJ_RC.
    */
   uint8_t flags;
 
@@ -1512,6 +1635,18 @@ enum gab_flags {
    * When any fiber panics, send SIGTERM to the engine.
    */
   fGAB_SIGTERM_ON_ERR = 1 << 5,
+
+  /*
+   * Periodically sample the frames of running fibers.
+   * @see gab_create_argt::profile
+   */
+  fGAB_PROFILE = 1 << 6,
+
+  /*
+   * Optimize ASTs in @gab_build before compiling them - folding constants,
+   * propagating literal locals and dropping tuples with no effect.
+   */
+  fGAB_OPTIMIZE = 1 << 7,
 };
 
 /**
@@ -1585,6 +1720,15 @@ struct gab_create_argt {
   struct gab_package {
     const char *package, *module, *alias;
   } *packages;
+
+  /*
+   * When fGAB_PROFILE is set, the sampled stacks are written here when the
+   * engine is destroyed, in the 'collapsed' format understood by
+   * flamegraph.pl and friends:
+   *
+   * <module>:<line>:<token>;<module>:<line>:<token> <microseconds>
+   */
+  FILE *profile;
 };
 
 /**
@@ -1607,6 +1751,10 @@ struct gab_module_res {
  * @brief resolve a module with the engine's given loaders and roots.
  * The prefix and suffix that matched are written to prefix and suffix, if
  * provided.
+ *
+ * Outcomes are cached for the lifetime of the engine - including misses. A
+ * module which appears on disk after a failed resolve stays missing, unless
+ * fGAB_USE_RELOAD is set. The returned path is owned by the engine.
  */
 GAB_API struct gab_module_res
 gab_resolve(struct gab_triple gab, const char *package, const char *module);
@@ -2644,6 +2792,89 @@ GAB_API void gab_gclock(struct gab_triple gab);
  */
 GAB_API void gab_gcunlock(struct gab_triple gab);
 
+/*
+ * What caused a collection to be signalled.
+ */
+enum gab_gctrigger {
+  // Some caller asked for a collection - see gab_asigcoll.
+  kGAB_GCTRIGGER_EXPLICIT,
+  // A job ran out of room in its rc buffers.
+  kGAB_GCTRIGGER_BUFFER,
+  kGAB_NGCTRIGGERS,
+};
+
+/*
+ * Durations are bucketed by powers of two, in microseconds.
+ * Bucket i counts durations in [2^i, 2^(i+1)) us. The first bucket also
+ * holds anything shorter, and the last anything longer.
+ */
+#define GAB_GCSTATS_NBUCKETS 16
+
+/**
+ * @class gab_gcstats
+ * @brief A snapshot of the collector's telemetry.
+ *
+ * The counters are maintained with relaxed atomics, so a snapshot taken while
+ * the engine is running is consistent per-field, but not across fields.
+ */
+struct gab_gcstats {
+  // Live objects and bytes, per kind.
+  int64_t objects[kGAB_NKINDS];
+  int64_t bytes[kGAB_NKINDS];
+
+  // Objects and bytes allocated over the lifetime of the engine.
+  uint64_t allocations, allocated_bytes;
+
+  // Completed collections, and the signals which caused them.
+  uint64_t collections;
+  uint64_t triggers[kGAB_NGCTRIGGERS];
+
+  // Time spent by the gc thread in each collection.
+  uint64_t collect_ns, collect_max_ns;
+  uint64_t collect_hist[GAB_GCSTATS_NBUCKETS];
+
+  // Time spent by jobs scanning their roots at the end of each epoch.
+  uint64_t pause_ns, pause_max_ns;
+  uint64_t pause_hist[GAB_GCSTATS_NBUCKETS];
+
+  // Objects waiting in the dead lists, and objects whose reference count
+  // overflowed, as of the end of the last collection.
+  uint64_t dead, overflow_rc;
+
+  // The number of jobs - including the gc job - @see gab_gcjobstats.
+  uint64_t njobs;
+};
+
+/**
+ * @class gab_gcjobstats
+ * @brief The high-water marks of a single job's gc buffers.
+ */
+struct gab_gcjobstats {
+  uint64_t stack_hwm, inc_hwm, dec_hwm, young_hwm;
+};
+
+/**
+ * @brief Take a snapshot of the collector's telemetry.
+ *
+ * This is cheap enough to call while the engine is running. For the
+ * collector itself, @see gab_gc.
+ *
+ * @param gab The triple.
+ * @param out The struct to fill.
+ */
+GAB_API void gab_gcstats(struct gab_triple gab, struct gab_gcstats *out);
+
+/**
+ * @brief Take a snapshot of a single job's buffer high-water marks.
+ *
+ * @param gab The triple.
+ * @param wkid The job, less than gab_gcstats::njobs.
+ * @param out The struct to fill.
+ * @return false if there is no such job.
+ */
+GAB_API bool gab_gcjobstats(struct gab_triple gab, uint64_t wkid,
+                            struct gab_gcjobstats *out);
+
 /**
  * @brief Get the name of a source file - aka the fully qualified path.
  *
@@ -2732,6 +2963,41 @@ GAB_API gab_value gab_nstring(struct gab_triple gab, uint64_t len,
 GAB_API gab_value gab_tnstring(struct gab_triple gab, uint64_t len,
                                const char *data);
 
+/**
+ * @brief Create a gab_value from a bounded array of chars, without interning
+ * it.
+ *
+ * Interned strings are compared by identity, but creating one means a trip
+ * through the engine's global intern table. Large strings such as file
+ * contents or response bodies are rarely compared, so they skip the table.
+ * Strings longer than cGAB_STRING_INTERN_MAX are always created this way.
+ *
+ * Strings created this way are interned when they are first used as a key in
+ * a record or shape, and are compared with '==' by their contents.
+ *
+ * @param gab The engine.
+ * @param len The length of the string.
+ * @param data The data.
+ * @return The value.
+ */
+GAB_API gab_value gab_nbigstring(struct gab_triple gab, uint64_t len,
+                                 const char *data);
+
+/**
+ * @brief Return the interned twin of a string, message or binary - interning
+ * it if it has none. Values which are already interned (and every value that
+ * isn't a string) are returned as they are.
+ *
+ * Anything which compares values by identity - message specs, send caches,
+ * c dicts keyed on gab_value - should intern strings made with
+ * gab_nbigstring before using them.
+ *
+ * @param gab The engine.
+ * @param str The value.
+ * @return The interned value, or gab_cinvalid if the engine is shutting down.
+ */
+GAB_API gab_value gab_strintern(struct gab_triple gab, gab_value str);
+
 /**
  * @brief Create a gab_value from a c-string
  *
@@ -2815,6 +3081,41 @@ GAB_API uint64_t gab_strlen(gab_value str);
  */
 GAB_API uint64_t gab_strmblen(gab_value str);
 
+/**
+ * @brief Check if a string is entirely ascii. This is constant-time (more or
+ * less), as the check falls out of counting codepoints when the string is
+ * created.
+ *
+ * In an ascii string, each byte is its own codepoint.
+ *
+ * @param str The string.
+ * @return true if every byte in the string is ascii.
+ */
+GAB_API bool gab_strisascii(gab_value str);
+
+/**
+ * @brief Get the index cached on a string with gab_strsetindex.
+ *
+ * @param str The string.
+ * @return The index, or nullptr if there isn't one.
+ */
+GAB_API void *gab_strindex(gab_value str);
+
+/**
+ * @brief Cache an index on a string, such as the offsets of its graphemes.
+ * Computing these is linear in the length of the string, and strings are
+ * immutable - so the work only needs to be done once.
+ *
+ * On success the string owns the index, and frees it (with free) when the
+ * string is collected.
+ *
+ * @param str The string.
+ * @param index The index, allocated with malloc.
+ * @return false if the string already has an index (or is a short string,
+ * with nowhere to keep one). In this case, the caller still owns 'index'.
+ */
+GAB_API bool gab_strsetindex(gab_value str, void *index);
+
 /**
  * @brief Get a string's hash. This a constant-time.
  *
@@ -2854,6 +3155,9 @@ GAB_API_INLINE gab_value gab_strtobin(gab_value str) {
 /**
  * @brief Create a new message object.
  *
+ * Messages are always interned, even past cGAB_STRING_INTERN_MAX - specs and
+ * send caches compare them by identity.
+ *
  * @param gab The gab engine.
  * @param len The number of bytes in data.
  * @param data The name of the message.
@@ -2861,7 +3165,7 @@ GAB_API_INLINE gab_value gab_strtobin(gab_value str) {
  */
 GAB_API_INLINE gab_value gab_nmessage(struct gab_triple gab, uint64_t len,
                                       const char *data) {
-  return gab_strtomsg(gab_nstring(gab, len, data));
+  return gab_strtomsg(gab_strintern(gab, gab_nstring(gab, len, data)));
 }
 
 /**
@@ -2872,7 +3176,7 @@ GAB_API_INLINE gab_value gab_nmessage(struct gab_triple gab, uint64_t len,
  * @return The new message object.
  */
 GAB_API_INLINE gab_value gab_message(struct gab_triple gab, const char *data) {
-  return gab_strtomsg(gab_string(gab, data));
+  return gab_nmessage(gab, strlen(data), data);
 }
 
 /**
@@ -2958,6 +3262,14 @@ GAB_API_INLINE gab_value gab_nbinary(struct gab_triple gab, uint64_t len,
   return gab_strtobin(gab_nstring(gab, len, (const char *)data));
 }
 
+/**
+ * @brief Create a binary without interning it. @see gab_nbigstring
+ */
+GAB_API_INLINE gab_value gab_nbigbinary(struct gab_triple gab, uint64_t len,
+                                        const uint8_t *data) {
+  return gab_strtobin(gab_nbigstring(gab, len, (const char *)data));
+}
+
 GAB_API_INLINE gab_value gab_nbincat(struct gab_triple gab, gab_value a,
                                      uint64_t len, const uint8_t *b) {
   assert(gab_valkind(a) == kGAB_BINARY);
@@ -3808,6 +4120,14 @@ GAB_API gab_value gab_prototype(struct gab_triple gab, struct gab_src *src,
 
 GAB_API gab_value gab_prtenv(gab_value prt);
 
+/**
+ * @brief Get the number of bytes of bytecode in a prototype.
+ *
+ * @param prt The prototype.
+ * @return The length of its bytecode.
+ */
+GAB_API uint64_t gab_prtlen(gab_value prt);
+
 GAB_API_INLINE gab_value gab_prtrec(gab_value prt) {
   gab_value env = gab_prtenv(prt);
   uint64_t len = gab_reclen(env);
@@ -5,6 +5,30 @@
 #include <stdatomic.h>
 #include <stdint.h>
 
+/*
+ * Multiply two words into 128 bits, and fold the halves together.
+ * This is the mixing step of every hash in the engine.
+ */
+static inline uint64_t __gab_hshmix(uint64_t a, uint64_t b) {
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+/*
+ * Scramble a pointer or nan-boxed key before it picks a bucket.
+ * dict.h masks off the low bits of a hash, and the low bits of these keys are
+ * almost always zero.
+ *
+ * Short strings are nan-boxed by value, so their keys can be chosen by
+ * whoever supplies them - the mix is seeded so that colliding keys can't be
+ * precomputed. A dict doesn't know which engine it belongs to, so this seed
+ * is per process rather than per engine. It is drawn once, by the first
+ * gab_create, before any of these dicts exist.
+ */
+static uint64_t __gab_hshkeyseed = 0x9e3779b97f4a7c15ull;
+
+#define GAB_HSHKEY(k) __gab_hshmix((uint64_t)(k), __gab_hshkeyseed)
+
 /*
  * Generic data structure definitions.
  *
@@ -49,10 +73,14 @@
 #define T uint64_t
 #include "array.h"
 
+#define T a_uint64_t *
+#define NAME a_uint64_t
+#include "vector.h"
+
 #define K uint64_t
 #define V uint64_t
 #define DEF_V 0
-#define HASH(a) a
+#define HASH(a) GAB_HSHKEY(a)
 #define EQUAL(a, b) (a == b)
 #define LOAD cGAB_DICT_MAX_LOAD
 #include "dict.h"
@@ -99,6 +127,15 @@ struct gab_vm {
 struct gab_ostring {
   struct gab_obj header;
 
+  /**
+   * Whether this string is in the engine's intern table.
+   * Strings that aren't (see gab_nbigstring) may share their contents with
+   * another string, so they are compared by their contents.
+   *
+   * Only ever set from false to true, under the gc_mtx - but read without it.
+   */
+  _Atomic bool interned;
+
   /**
    * A pre-computed hash of the bytes in 'data'.
    */
@@ -116,6 +153,12 @@ struct gab_ostring {
    */
   uint64_t len;
 
+  /**
+   * An index into 'data', built lazily by whoever needs one.
+   * @see gab_strsetindex
+   */
+  _Atomic(void *) index;
+
   /**
    * The data.
    */
@@ -383,9 +426,11 @@ struct gab_orec {
   uint8_t len;
 
   /**
-   * @brief shift value used to index tree as depth increases.
+   * @brief shift value used to index tree as depth increases. This is always
+   * a multiple of GAB_PVEC_BITS below 64, so 1 byte is plenty - and keeps
+   * the record header within 8 bytes.
    */
-  int32_t shift;
+  uint8_t shift;
 
   /**
    * @brief The shape of this record. This determines the length of the record
@@ -565,11 +610,29 @@ struct gab_oprototype {
 #define EQUAL(a, b) (a == b)
 #include "dict.h"
 
+/*
+ * The resolution cache is keyed by the raw 'package:module' bytes, so that a
+ * hit needs neither an allocation nor the gc lock. The name is owned by the
+ * cache, and freed in gab_destroy.
+ */
+struct gab_reskey {
+  uint64_t hash;
+  const char *name;
+};
+
+#define NAME gab_resolved
+#define K struct gab_reskey
+#define V struct gab_module_res
+#define DEF_V ((struct gab_module_res){0})
+#define HASH(a) (a.hash)
+#define EQUAL(a, b) (a.hash == b.hash && !strcmp(a.name, b.name))
+#include "dict.h"
+
 #define NAME gab_src
 #define K gab_value
 #define V struct gab_src *
 #define DEF_V nullptr
-#define HASH(a) (a)
+#define HASH(a) GAB_HSHKEY(a)
 #define EQUAL(a, b) (a == b)
 #include "dict.h"
 
@@ -580,10 +643,10 @@ struct gab_oprototype {
 #define NAME gab_obj
 #define K struct gab_obj *
 #define V uint64_t
-#define HASH(a) ((intptr_t)a)
+#define HASH(a) GAB_HSHKEY((uintptr_t)a)
 #define EQUAL(a, b) (a == b)
-// See do_increment
-#define DEF_V (UINT8_MAX)
+// See __gab_gcobjinc
+#define DEF_V (GAB_OBJ_RC_MAX)
 #include "dict.h"
 
 enum {
@@ -599,6 +662,22 @@ struct gab_gc {
   d_gab_obj overflow_rc;
   v_gab_obj dead[GAB_GCNEPOCHS];
   gab_value msg[GAB_GCNEPOCHS];
+
+  // Telemetry, read through gab_gcstats.
+  // Collections are recorded by the gc thread, pauses and triggers by the
+  // jobs which experience them.
+  struct gab_gctelemetry {
+    _Atomic uint64_t collections;
+    _Atomic uint64_t triggers[kGAB_NGCTRIGGERS];
+
+    _Atomic uint64_t collect_ns, collect_max_ns;
+    _Atomic uint64_t collect_hist[GAB_GCSTATS_NBUCKETS];
+
+    _Atomic uint64_t pause_ns, pause_max_ns;
+    _Atomic uint64_t pause_hist[GAB_GCSTATS_NBUCKETS];
+
+    _Atomic uint64_t dead, overflow_rc;
+  } stats;
 };
 
 typedef enum gab_token {
@@ -630,6 +709,29 @@ struct gab_src {
   d_uint64_t node_begin_toks;
   d_uint64_t node_end_toks;
 
+  /**
+   * Set while a thread is parsing or compiling into this source. Different
+   * sources build concurrently, but two builds of the *same* source would
+   * interleave their tokens and bytecode - so they take turns.
+   */
+  atomic_bool building;
+
+  /**
+   * The bytecode and constants as they were when the source was last
+   * completed. Threads copy from this lazily, the first time they run code
+   * from this source. Threads which never do so don't pay for a copy.
+   *
+   * Completing the source again updates the snapshot in place and bumps
+   * snapshot_gen. Both the update and the threads' copying hold snapshot_mtx.
+   */
+  mtx_t snapshot_mtx;
+  _Atomic uint64_t snapshot_gen;
+  struct src_snapshot {
+    uint64_t bytecode_len, constants_len;
+    uint8_t *bytecode;
+    gab_value *constants;
+  } snapshot;
+
   uint64_t len;
   /**
    * Each OS thread needs its own copy of the bytecode and constants.
@@ -639,6 +741,17 @@ struct gab_src {
   struct src_bytecode {
     uint8_t *bytecode;
     gab_value *constants;
+
+    // How much of the snapshot has been copied, and how much room there is.
+    uint64_t bytecode_len, constants_len;
+    uint64_t bytecode_cap, constants_cap;
+
+    // The snapshot_gen this copy is up to date with.
+    uint64_t gen;
+
+    // Copies this thread has outgrown. Frames may still be running within
+    // them, so they are kept until the source is destroyed.
+    struct src_bytecode *prev;
   } thread_bytecode[];
 };
 
@@ -649,15 +762,13 @@ struct gab_src {
 struct gab_eg {
   uint64_t hash_seed;
 
+  mtx_t scratch_mtx;
   v_gab_value scratch;
 
   v_gab_value_thrd err;
 
   gab_value types[kGAB_NKINDS];
 
-  int64_t sizes[kGAB_NKINDS];
-  int64_t counts[kGAB_NKINDS];
-
   // The arguments to the engine.
   gab_value args;
 
@@ -708,6 +819,14 @@ struct gab_eg {
   mtx_t modules_mtx;
   d_gab_modules modules;
 
+  // Table of cached module resolutions, also guarded by modules_mtx.
+  // Keyed by the interned 'package:module' string.
+  // Misses are cached too - as a resolution with no resource.
+  d_gab_resolved resolved;
+
+  // Where to write sampled stacks, when profiling.
+  FILE *profile;
+
   // Configured busywait value, and number of jobs.
   uint32_t wait, len;
 
@@ -743,6 +862,50 @@ struct gab_eg {
       uint64_t len;
       struct gab_obj *data[GAB_GC_MOD_BUFF_MAX];
     } buffers[kGAB_NBUF][GAB_GCNEPOCHS];
+
+    // Objects created by this job in each epoch. Their creation reference is
+    // dropped by the collector, without passing through the buffers above.
+    v_gab_obj young[GAB_GCNEPOCHS];
+
+    // Pending rc events which haven't reached the buffers yet.
+    // Each slot holds a delta of exactly +1 or -1, and is flushed
+    // into the buffers at the end of the epoch.
+    struct gab_gcrc {
+      struct gab_obj *obj;
+      int32_t delta;
+    } rc[cGAB_GC_RC_CACHE_LEN];
+
+    // Objects and bytes created (and, for the gc job, destroyed) per kind.
+    // These are summed across jobs by gab_gcstats. Keeping them per-job
+    // keeps the counters from bouncing between cores on every allocation.
+    _Atomic int64_t objects[kGAB_NKINDS];
+    _Atomic int64_t bytes[kGAB_NKINDS];
+
+    // Objects and bytes ever allocated by this job.
+    _Atomic uint64_t allocations, allocated_bytes;
+
+    // The fullest each buffer has been when the gc cleared it.
+    _Atomic uint64_t hwm[kGAB_NBUF];
+    _Atomic uint64_t young_hwm;
+
+    // Sampling profiler state, used when fGAB_PROFILE is set.
+    // Stacks are keyed by a hash of their frames, and map to
+    // (index + 1) into the collapsed stacks and their weights. The frames
+    // themselves are kept so that colliding hashes can be told apart.
+    uint32_t prof_ticks;
+    uint64_t prof_last;
+    d_uint64_t prof_index;
+    v_a_char prof_stacks;
+    v_a_uint64_t prof_frames;
+    v_uint64_t prof_weights;
+
+#if cGAB_LOG_VM_SEQUENCES
+    // The last two opcodes dispatched by this job, and how often each pair
+    // and triple of opcodes has been dispatched.
+    uint8_t seq_ops[2];
+    uint64_t seq_n;
+    d_uint64_t seq_counts;
+#endif
   } jobs[];
 };
 
@@ -815,14 +978,76 @@ GAB_API int64_t gab_fmodinspect(FILE *stream, gab_value prototype);
  */
 GAB_API int64_t gab_fvalinspect(FILE *stream, gab_value self, int depth);
 
+/*
+ * Bring this thread's copy up to date with the source's snapshot.
+ *
+ * Code is only ever appended to a source, so when the new snapshot still fits
+ * only its tail is copied - the copy stays where it is, along with the
+ * specializations already made in it. Otherwise the copy moves to a buffer
+ * twice the size, and the old one is kept for the frames still running in it.
+ * Those outgrown copies add up to less than the current one.
+ */
+static void src_threadcopy(struct gab_src *src, struct src_bytecode *tb) {
+  mtx_lock(&src->snapshot_mtx);
+
+  struct src_snapshot *s = &src->snapshot;
+
+  if (s->bytecode_len > tb->bytecode_cap ||
+      s->constants_len > tb->constants_cap) {
+    if (tb->bytecode) {
+      struct src_bytecode *prev = malloc(sizeof(struct src_bytecode));
+      *prev = *tb;
+      tb->prev = prev;
+    }
+
+    tb->bytecode_cap = s->bytecode_len * 2;
+    tb->constants_cap = s->constants_len * 2;
+    tb->bytecode = malloc(tb->bytecode_cap);
+    tb->constants = malloc(tb->constants_cap * sizeof(gab_value));
+    tb->bytecode_len = tb->constants_len = 0;
+  }
+
+  memcpy(tb->bytecode + tb->bytecode_len, s->bytecode + tb->bytecode_len,
+         s->bytecode_len - tb->bytecode_len);
+
+  memcpy(tb->constants + tb->constants_len, s->constants + tb->constants_len,
+         (s->constants_len - tb->constants_len) * sizeof(gab_value));
+
+  tb->bytecode_len = s->bytecode_len;
+  tb->constants_len = s->constants_len;
+  tb->gen = atomic_load_explicit(&src->snapshot_gen, memory_order_relaxed);
+
+  mtx_unlock(&src->snapshot_mtx);
+}
+
+/*
+ * Get this thread's copy of a source's bytecode and constants. The copy is
+ * taken from the snapshot the first time this thread needs it, and brought up
+ * to date whenever the source has been completed since.
+ *
+ * Each thread only ever writes its own slot, so only a stale copy needs the
+ * lock.
+ */
+static inline struct src_bytecode *src_thread(struct gab_triple gab,
+                                              struct gab_src *src) {
+  struct src_bytecode *tb = src->thread_bytecode + gab.wkid;
+
+  if (__gab_unlikely(tb->gen !=
+                     atomic_load_explicit(&src->snapshot_gen,
+                                          memory_order_acquire)))
+    src_threadcopy(src, tb);
+
+  return tb;
+}
+
 static inline uint8_t *proto_srcbegin(struct gab_triple gab,
                                       struct gab_oprototype *p) {
-  return p->src->thread_bytecode[gab.wkid].bytecode;
+  return src_thread(gab, p->src)->bytecode;
 }
 
 static inline gab_value *proto_ks(struct gab_triple gab,
                                   struct gab_oprototype *p) {
-  return p->src->thread_bytecode[gab.wkid].constants;
+  return src_thread(gab, p->src)->constants;
 }
 
 static inline uint8_t *proto_ip(struct gab_triple gab,
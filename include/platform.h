@@ -21,6 +21,10 @@
  * gab_oslibfind(dynlib, name)
  * Find a symbol *name* in the dynamic library *dynlib*.
  *
+ * gab_osmemlib(name, len, data) (linux only)
+ * Put a dynamic library's bytes in an anonymous in-memory file, and return a
+ * path which gab_oslibopen can open.
+ *
  * %-----------------%
  * | File Operations |
  * %-----------------%
@@ -185,6 +189,42 @@ GAB_API_INLINE const char *gab_osexepath() {
 #define gab_oslibopen(path) dlopen(path, RTLD_NOW)
 #define gab_oslibfind(dynlib, name) (void *)dlsym(dynlib, name)
 
+#ifdef GAB_PLATFORM_LINUX
+#include <sys/mman.h>
+
+/*
+ * The file lives for as long as the process does - its descriptor is
+ * intentionally never closed, as its path is how the loader finds it.
+ */
+GAB_API_INLINE char *gab_osmemlib(const char *name, uint64_t len,
+                                  const void *data) {
+  int fd = memfd_create(name, MFD_CLOEXEC);
+
+  if (fd < 0)
+    return nullptr;
+
+  for (uint64_t written = 0; written < len;) {
+    ssize_t n = write(fd, (const char *)data + written, len - written);
+
+    if (n < 0 && errno == EINTR)
+      continue;
+
+    if (n <= 0)
+      return close(fd), nullptr;
+
+    written += n;
+  }
+
+  v_char str = {0};
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "/proc/self/fd/%d", fd);
+  v_char_spush(&str, s_char_cstr(buffer));
+  v_char_push(&str, '\0');
+
+  return str.data;
+}
+#endif
+
 #define gab_oschmod(path, perms) (chmod(path, perms))
 #define gab_ossymlink(from, to) (symlink(to, from))
 
@@ -66,39 +66,132 @@ static inline void v_char_spush(v_char *self, s_char slice) {
  */
 #define popcountl(n) __builtin_popcountl(n)
 #define ctzl(n) __builtin_ctzl(n)
+#define clzl(n) __builtin_clzl(n)
 
-/* Hashing */
-// https://github.com/amakukha/minimal_hashes
-GAB_INTERNAL uint64_t __gab_hshFNV1a_64(uint64_t seed, uint64_t len,
-                                        const uint8_t *data) {
-  uint64_t h = seed;
+/* A monotonic clock, where the platform has one. */
+GAB_INTERNAL uint64_t __gab_nowns() {
+  struct timespec ts;
+#ifdef TIME_MONOTONIC
+  timespec_get(&ts, TIME_MONOTONIC);
+#else
+  timespec_get(&ts, TIME_UTC);
+#endif
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
 
-  for (uint64_t i = 0; i < len; i++) {
-    h ^= data[i];
-    h *= (uint64_t)0x00000100000001B3UL;
-  }
+/* Hashing */
+// Based on wyhash (final version 4), https://github.com/wangyi-fudan/wyhash
+static const uint64_t __gab_hshsecret[4] = {
+    0x2d358dccaa6c78a5ull,
+    0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull,
+};
 
-  return h;
+static inline uint64_t __gab_hshr8(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
 }
 
-GAB_INTERNAL uint64_t __gab_hshbytes(uint64_t len, uint8_t *bytes) {
-  return __gab_hshFNV1a_64(0xcbf29ce484222325UL, len * sizeof(uint8_t),
-                           (void *)bytes);
+static inline uint64_t __gab_hshr4(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
 }
 
-GAB_INTERNAL uint64_t __gab_hshwords(uint64_t len, uint64_t *bytes) {
-  return __gab_hshFNV1a_64(0xcbf29ce484222325UL, len * sizeof(uint64_t),
-                           (void *)bytes);
+/*
+ * Hash all of 'len' bytes of 'data'.
+ *
+ * Inputs of 48 bytes or more are consumed by three independent multiply
+ * lanes, which the compiler can keep in flight at once.
+ */
+GAB_INTERNAL uint64_t __gab_hshbytes(uint64_t seed, uint64_t len,
+                                     const uint8_t *p) {
+  const uint64_t *s = __gab_hshsecret;
+  uint64_t a, b;
+
+  seed ^= __gab_hshmix(seed ^ s[0], s[1]);
+
+  if (__gab_likely(len <= 16)) {
+    if (__gab_likely(len >= 4)) {
+      a = (__gab_hshr4(p) << 32) | __gab_hshr4(p + ((len >> 3) << 2));
+      b = (__gab_hshr4(p + len - 4) << 32) |
+          __gab_hshr4(p + len - 4 - ((len >> 3) << 2));
+    } else if (__gab_likely(len > 0)) {
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    uint64_t i = len;
+
+    if (__gab_unlikely(i >= 48)) {
+      uint64_t see1 = seed, see2 = seed;
+
+      do {
+        seed = __gab_hshmix(__gab_hshr8(p) ^ s[1], __gab_hshr8(p + 8) ^ seed);
+        see1 =
+            __gab_hshmix(__gab_hshr8(p + 16) ^ s[2], __gab_hshr8(p + 24) ^ see1);
+        see2 =
+            __gab_hshmix(__gab_hshr8(p + 32) ^ s[3], __gab_hshr8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (__gab_likely(i >= 48));
+
+      seed ^= see1 ^ see2;
+    }
+
+    while (__gab_unlikely(i > 16)) {
+      seed = __gab_hshmix(__gab_hshr8(p) ^ s[1], __gab_hshr8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+
+    a = __gab_hshr8(p + i - 16);
+    b = __gab_hshr8(p + i - 8);
+  }
+
+  __uint128_t r = (__uint128_t)(a ^ s[1]) * (b ^ seed);
+  a = (uint64_t)r;
+  b = (uint64_t)(r >> 64);
+
+  return __gab_hshmix(a ^ s[0] ^ len, b ^ s[1]);
 }
 
-/* continue-hashing words */
+/*
+ * Continue hashing 'len' words onto 'sofar'.
+ *
+ * Words are mixed in one at a time, so that hashing a prefix and continuing
+ * with the rest is the same as hashing the whole. Shapes rely on this to
+ * extend a shape's hash by a key.
+ */
 GAB_INTERNAL uint64_t __gab_chshwords(uint64_t sofar, uint64_t len,
-                                      uint64_t *bytes) {
-  return __gab_hshFNV1a_64(sofar, len * sizeof(uint64_t), (void *)bytes);
+                                      const uint64_t *words) {
+  for (uint64_t i = 0; i < len; i++)
+    sofar = __gab_hshmix(sofar ^ __gab_hshsecret[0], words[i] ^ __gab_hshsecret[1]);
+
+  return sofar;
 }
 
-static inline uint64_t s_char_hash(s_char self) {
-  return __gab_hshbytes(self.len, (uint8_t *)self.data);
+GAB_INTERNAL uint64_t __gab_hshwords(uint64_t seed, uint64_t len,
+                                     const uint64_t *words) {
+  return __gab_chshwords(seed, len, words);
+}
+
+/*
+ * Hash the contents of a string.
+ * @see cGAB_STRING_HASHLEN
+ */
+GAB_INTERNAL uint64_t __gab_hshstr(struct gab_eg *eg, uint64_t len,
+                                   const char *data) {
+#if cGAB_STRING_HASHLEN > 0
+  if (len > cGAB_STRING_HASHLEN)
+    len = cGAB_STRING_HASHLEN;
+#endif
+
+  return __gab_hshbytes(eg->hash_seed, len, (const uint8_t *)data);
 }
 
 /* Helpers used by all the sprintf methods */
@@ -106,7 +199,13 @@ GAB_INTERNAL int64_t __gab_vsnprintf_through(char **dst, uint64_t *n,
                                              const char *fmt, va_list va) {
   int res = vsnprintf(*dst, *n, fmt, va);
 
-  if (res > *n) {
+  // An encoding error, which more room won't fix. Leave *n as it is, so that
+  // callers can tell this apart from truncation.
+  if (res < 0)
+    return -1;
+
+  // vsnprintf needs room for its nul terminator as well.
+  if (res >= *n) {
     *dst += *n;
     *n = 0;
     return -1;
@@ -627,33 +726,99 @@ GAB_INTERNAL void __gab_srcdestroy(struct gab_src *self) {
   d_uint64_t_destroy(&self->node_end_toks);
 
   for (uint64_t i = 0; i < self->len; i++) {
-    if (self->thread_bytecode[i].constants)
-      free(self->thread_bytecode[i].constants);
-    if (self->thread_bytecode[i].bytecode)
-      free(self->thread_bytecode[i].bytecode);
+    struct src_bytecode *tb = self->thread_bytecode + i;
+
+    free(tb->constants);
+    free(tb->bytecode);
+
+    while (tb->prev) {
+      struct src_bytecode *prev = tb->prev;
+      tb->prev = prev->prev;
+
+      free(prev->constants);
+      free(prev->bytecode);
+      free(prev);
+    }
   }
 
+  free(self->snapshot.constants);
+  free(self->snapshot.bytecode);
+  mtx_destroy(&self->snapshot_mtx);
+
   free(self);
 }
 
-GAB_INTERNAL struct gab_src *__gab_source(struct gab_triple gab, gab_value name,
-                                          const char *source, uint64_t len) {
+/*
+ * Drop a source which lost the race to be inserted into the sources table.
+ *
+ * It has only been lexed: its tokens are slices of its own source buffer, and
+ * its only constants are the immediates seeded by __gab_lexcreate. So it holds
+ * no references, and destroying it releases everything it owns. Should the
+ * lexer ever start creating heap values, this is where they must be released.
+ */
+GAB_INTERNAL void __gab_srcdiscard(struct gab_src *self) {
+  for (uint64_t i = 0; i < self->constants.len; i++)
+    gab_assert(!gab_valiso(v_gab_value_val_at(&self->constants, i)),
+               "A source which was only lexed shall hold no heap values");
+
+  __gab_srcdestroy(self);
+}
+
+GAB_INTERNAL struct gab_src *__gab_srcat(struct gab_triple gab,
+                                         gab_value name) {
   mtx_lock(&gab.eg->sources_mtx);
 
-  if (d_gab_src_exists(&gab.eg->sources, name)) {
-    if (gab.flags & fGAB_USE_RELOAD) {
-      // We should really free some resources here.
-      // Eh, there are a lot of pointers dangling into this.
-      // Probably best to just save it somewhere else.
-    } else {
-      struct gab_src *src = d_gab_src_read(&gab.eg->sources, name);
+  struct gab_src *src = d_gab_src_exists(&gab.eg->sources, name)
+                            ? d_gab_src_read(&gab.eg->sources, name)
+                            : nullptr;
+
+  mtx_unlock(&gab.eg->sources_mtx);
 
-      mtx_unlock(&gab.eg->sources_mtx);
+  return src;
+}
 
-      return src;
+/*
+ * Wait for any other thread building into this source to finish.
+ * Like gab_tfibawait, keep answering collection signals while we wait.
+ */
+GAB_INTERNAL void __gab_srcacquire(struct gab_triple gab,
+                                   struct gab_src *self) {
+  while (atomic_exchange(&self->building, true)) {
+    switch (gab_yield(gab)) {
+    case sGAB_COLL:
+      gab_gcepochnext(gab);
+      gab_sigpropagate(gab);
+      break;
+    default:
+      break;
     }
+
+    gab_busywait(gab);
+  }
+}
+
+GAB_INTERNAL void __gab_srcrelease(struct gab_src *self) {
+  atomic_store(&self->building, false);
+}
+
+/*
+ * Lexing happens outside of the sources lock, so that modules being loaded
+ * on different threads don't wait on each other. The lock only guards the
+ * table itself.
+ */
+GAB_INTERNAL struct gab_src *__gab_source(struct gab_triple gab, gab_value name,
+                                          const char *source, uint64_t len) {
+  if (!(gab.flags & fGAB_USE_RELOAD)) {
+    struct gab_src *src = __gab_srcat(gab, name);
+
+    if (src)
+      return src;
   }
 
+  // When reloading, we should really free some resources of the old source.
+  // Eh, there are a lot of pointers dangling into it.
+  // Probably best to just save it somewhere else.
+
   uint64_t sz =
       sizeof(struct gab_src) + (gab.eg->len) * sizeof(struct src_bytecode);
 
@@ -663,8 +828,7 @@ GAB_INTERNAL struct gab_src *__gab_source(struct gab_triple gab, gab_value name,
   src->len = gab.eg->len;
   src->source = a_char_create(source, len);
   src->name = name;
-
-  gab_egkeep(gab.eg, gab_iref(gab, name));
+  mtx_init(&src->snapshot_mtx, mtx_plain);
 
   if (!len)
     goto fin;
@@ -680,10 +844,25 @@ GAB_INTERNAL struct gab_src *__gab_source(struct gab_triple gab, gab_value name,
   }
 
 fin:
+  mtx_lock(&gab.eg->sources_mtx);
+
+  if (!(gab.flags & fGAB_USE_RELOAD) &&
+      d_gab_src_exists(&gab.eg->sources, name)) {
+    // Another thread lexed the same source while we did. Keep theirs.
+    struct gab_src *other = d_gab_src_read(&gab.eg->sources, name);
+
+    mtx_unlock(&gab.eg->sources_mtx);
+
+    __gab_srcdiscard(src);
+    return other;
+  }
+
   d_gab_src_insert(&gab.eg->sources, name, src);
 
   mtx_unlock(&gab.eg->sources_mtx);
 
+  gab_egkeep(gab.eg, gab_iref(gab, name));
+
   return src;
 }
 
@@ -704,17 +883,34 @@ GAB_INTERNAL uint64_t __gab_srcappend(struct gab_src *self, uint64_t len,
   return self->bytecode.len;
 }
 
+/*
+ * Snapshot the bytecode and constants compiled so far. Each thread brings its
+ * own copy up to date when it next needs it - see src_thread.
+ *
+ * Completing a source again (ie: more code was compiled into it) replaces the
+ * snapshot, which threads notice by its generation. Nothing here touches
+ * another thread's copy.
+ */
 GAB_INTERNAL void __gab_srccomplete(struct gab_triple gab,
                                     struct gab_src *self) {
-  for (int i = 0; i < self->len; i++) {
-    uint8_t *bc = malloc(self->bytecode.len);
-    memcpy(bc, self->bytecode.data, self->bytecode.len);
+  mtx_lock(&self->snapshot_mtx);
 
-    gab_value *ks = malloc(self->constants.len * sizeof(gab_value));
-    memcpy(ks, self->constants.data, self->constants.len * sizeof(gab_value));
+  struct src_snapshot *s = &self->snapshot;
 
-    self->thread_bytecode[i] = (struct src_bytecode){bc, ks};
-  }
+  s->bytecode = realloc(s->bytecode, self->bytecode.len);
+  memcpy(s->bytecode, self->bytecode.data, self->bytecode.len);
+
+  s->constants =
+      realloc(s->constants, self->constants.len * sizeof(gab_value));
+  memcpy(s->constants, self->constants.data,
+         self->constants.len * sizeof(gab_value));
+
+  s->bytecode_len = self->bytecode.len;
+  s->constants_len = self->constants.len;
+
+  atomic_fetch_add_explicit(&self->snapshot_gen, 1, memory_order_release);
+
+  mtx_unlock(&self->snapshot_mtx);
 }
 
 GAB_API gab_value gab_srcname(struct gab_src *src) { return src->name; }
@@ -1086,7 +1282,13 @@ GAB_INTERNAL bool __gab_jbisalive(struct gab_triple gab, int32_t wkid) {
   return sig.mask & (1 << wkid);
 }
 
+GAB_INTERNAL void __gab_gcrcflush(struct gab_triple gab);
+
 GAB_INTERNAL void __gab_jbunalive(struct gab_triple gab, int32_t wkid) {
+  // Once this job is no longer alive, its epochs end without it. Make sure
+  // no rc events are left pending in its cache.
+  __gab_gcrcflush(gab);
+
   for (;;) {
     switch (gab_yield(gab)) {
     case sGAB_TERM:
@@ -1188,9 +1390,11 @@ int32_t __gab_jbgc(void *data) {
     case sGAB_COLL: {
 #if cGAB_LOG_EG
       fprintf(stderr, "[GCWORKER] COLLECTING\n");
+      struct gab_gcstats stats;
+      gab_gcstats(gab, &stats);
       for (int i = 0; i < kGAB_NKINDS; i++) {
-        uint64_t count = gab.eg->counts[i];
-        uint64_t total = gab.eg->sizes[i];
+        int64_t count = stats.objects[i];
+        int64_t total = stats.bytes[i];
         fprintf(stderr, "\t[%s] => %li objects, %li avg. %li total bytes.\n",
                 kind_strs[i], count, count ? total / count : 0, total);
       }
@@ -1597,10 +1801,24 @@ GAB_INTERNAL bool __gab_jbspawn(struct gab_triple gab, gab_value fiber) {
   return __gab_job(gab, __gab_jbnext(gab), __gab_jbworker, fiber);
 }
 
+GAB_INTERNAL void __gab_bcsuperinit();
+
+static once_flag __gab_hshkeyonce = ONCE_FLAG_INIT;
+
+static void __gab_hshkeyinit(void) {
+  __gab_hshkeyseed =
+      __gab_hshmix(time(nullptr) ^ (uintptr_t)&__gab_hshkeyseed,
+                   __gab_nowns() | 1) |
+      1;
+}
+
 GAB_API union gab_value_pair gab_create(struct gab_create_argt args,
                                         struct gab_triple gab_out[static 1]) {
   uint64_t njobs = args.jobs ? args.jobs : cGAB_DEFAULT_NJOBS;
 
+  __gab_bcsuperinit();
+  call_once(&__gab_hshkeyonce, __gab_hshkeyinit);
+
   if (njobs > 29)
     return (union gab_value_pair){{gab_cinvalid}};
 
@@ -1614,7 +1832,10 @@ GAB_API union gab_value_pair gab_create(struct gab_create_argt args,
 
   eg->wait = args.wait ? args.wait : cGAB_DEFAULT_WAIT_NS;
   eg->len = actual_njobs;
-  eg->hash_seed = time(nullptr);
+  // Seeded per engine, so that colliding keys can't be precomputed.
+  eg->hash_seed =
+      __gab_hshmix(time(nullptr) ^ (uintptr_t)eg, __gab_nowns() | 1);
+  eg->profile = args.profile;
   atomic_init(&eg->sig, (struct gab_sig){0, -1, 0});
 
   // The only non-zero initialization that jobs need is epoch = 1
@@ -1626,6 +1847,7 @@ GAB_API union gab_value_pair gab_create(struct gab_create_argt args,
   mtx_init(&eg->sources_mtx, mtx_plain);
   mtx_init(&eg->gc_mtx, mtx_plain);
   mtx_init(&eg->modules_mtx, mtx_plain);
+  mtx_init(&eg->scratch_mtx, mtx_plain);
 
   d_gab_src_create(&eg->sources, 8);
   d_strings_create(&eg->strings, 8);
@@ -1802,6 +2024,12 @@ GAB_API union gab_value_pair gab_create(struct gab_create_argt args,
 
 GAB_INTERNAL bool __gab_gcisdone(struct gab_triple gab);
 
+GAB_INTERNAL void __gab_profdump(struct gab_triple gab);
+
+GAB_INTERNAL void __gab_vmseqdump(struct gab_triple gab);
+
+GAB_INTERNAL void __gab_resfree(struct gab_module_res res);
+
 GAB_API void gab_destroy(struct gab_triple gab) {
   gab_precondition(gab.wkid == 1, "Shall only be called from the main thread");
 
@@ -1814,9 +2042,16 @@ GAB_API void gab_destroy(struct gab_triple gab) {
   while (gab_njobs(gab) > 1)
     gab_busywait(gab);
 
+  // Every job which could have sampled has now stopped.
+  __gab_profdump(gab);
+  __gab_vmseqdump(gab);
+
   gab_dref(gab, gab.eg->work_channel);
   gab_ndref(gab, 1, gab.eg->scratch.len, gab.eg->scratch.data);
 
+  // The main thread is no longer alive - flush these decrements ourselves.
+  __gab_gcrcflush(gab);
+
   atomic_store(&gab.eg->messages, gab_cinvalid);
 
   gab_assert(gab_njobs(gab) == 1,
@@ -1901,6 +2136,14 @@ GAB_API void gab_destroy(struct gab_triple gab) {
   d_strings_destroy(&gab.eg->strings);
   d_shapes_destroy(&gab.eg->shapes);
   d_gab_modules_destroy(&gab.eg->modules);
+  for (uint64_t i = 0; i < gab.eg->resolved.cap; i++) {
+    if (d_gab_resolved_iexists(&gab.eg->resolved, i)) {
+      free((char *)d_gab_resolved_ikey(&gab.eg->resolved, i).name);
+      __gab_resfree(d_gab_resolved_ival(&gab.eg->resolved, i));
+    }
+  }
+
+  d_gab_resolved_destroy(&gab.eg->resolved);
   d_gab_src_destroy(&gab.eg->sources);
 
   v_gab_value_destroy(&gab.eg->scratch);
@@ -1909,6 +2152,7 @@ GAB_API void gab_destroy(struct gab_triple gab) {
   mtx_destroy(&gab.eg->gc_mtx);
   mtx_destroy(&gab.eg->sources_mtx);
   mtx_destroy(&gab.eg->modules_mtx);
+  mtx_destroy(&gab.eg->scratch_mtx);
 
   free(gab.eg);
 }
@@ -2286,6 +2530,121 @@ GAB_INTERNAL struct gab_ostring *__gab_egstrfind(struct gab_eg *self,
   }
 }
 
+GAB_INTERNAL bool __gab_strisloose(gab_value v) {
+  if (!gab_valiso(v))
+    return false;
+
+  switch (gab_valkind(v)) {
+  case kGAB_STRING:
+  case kGAB_BINARY:
+  case kGAB_MESSAGE:
+    return !atomic_load(&GAB_VAL_TO_STRING(v)->interned);
+  default:
+    return false;
+  }
+}
+
+/*
+ * Compare two values, looking at the contents of strings which aren't
+ * interned. Interned strings (and every other value) are equal only if they
+ * are identical.
+ */
+GAB_INTERNAL bool __gab_valequal(gab_value a, gab_value b) {
+  if (gab_valeq(a, b))
+    return true;
+
+  if (!__gab_strisloose(a) && !__gab_strisloose(b))
+    return false;
+
+  if (!gab_valiso(a) || !gab_valiso(b) || gab_valkind(a) != gab_valkind(b))
+    return false;
+
+  struct gab_ostring *sa = GAB_VAL_TO_STRING(a);
+  struct gab_ostring *sb = GAB_VAL_TO_STRING(b);
+
+  return sa->len == sb->len && sa->hash == sb->hash &&
+         !memcmp(sa->data, sb->data, sa->len);
+}
+
+/*
+ * Return the interned twin of a string which isn't interned, keeping its kind.
+ * If there is no twin, the string itself is interned.
+ *
+ * The caller shall hold the gc_mtx.
+ */
+GAB_INTERNAL gab_value __gab_egstrintern(struct gab_eg *self, gab_value v) {
+  if (!__gab_strisloose(v))
+    return v;
+
+  struct gab_ostring *str = GAB_VAL_TO_STRING(v);
+  struct gab_ostring *twin =
+      __gab_egstrfind(self, str->hash, str->len, str->data);
+
+  if (!twin) {
+    atomic_store(&str->interned, true);
+    d_strings_insert(&self->strings, str, 0);
+    return v;
+  }
+
+  gab_value t = __gab_obj(twin);
+
+  switch (gab_valkind(v)) {
+  case kGAB_MESSAGE:
+    return gab_strtomsg(t);
+  case kGAB_BINARY:
+    return gab_strtobin(t);
+  default:
+    return t;
+  }
+}
+
+GAB_INTERNAL gab_value __gab_strintern(struct gab_triple gab, gab_value v) {
+  if (__gab_likely(!__gab_strisloose(v)))
+    return v;
+
+  switch (mtx_trylock(&gab.eg->gc_mtx)) {
+  case thrd_success:
+    break;
+  case thrd_busy:
+    return gab_ctimeout;
+  case thrd_error:
+    return gab_cinvalid;
+  }
+
+  v = __gab_egstrintern(gab.eg, v);
+
+  mtx_unlock(&gab.eg->gc_mtx);
+
+  return v;
+}
+
+GAB_API gab_value gab_strintern(struct gab_triple gab, gab_value str) {
+  for (;;) {
+    if (str == gab_cinvalid)
+      return str;
+
+    gab_value interned = __gab_strintern(gab, str);
+
+    if (interned != gab_ctimeout)
+      return interned;
+
+    switch (gab_yield(gab)) {
+    case sGAB_IGN:
+      break;
+    case sGAB_TERM:
+      return gab_cinvalid;
+    case sGAB_COLL:
+      gab_gcepochnext(gab);
+      gab_sigpropagate(gab);
+      break;
+    }
+  }
+}
+
+GAB_API bool gab_valequal(gab_value a, gab_value b) {
+  return __gab_valequal(a, b);
+}
+
 GAB_INTERNAL uint64_t __gab_shpnth(gab_value shape, uint64_t midx);
 GAB_INTERNAL bool __gab_shpisn(gab_value shape, uint64_t midx);
 GAB_INTERNAL bool __gab_shpisl(gab_value shape, uint64_t midx);
@@ -2440,7 +2799,7 @@ GAB_INTERNAL struct gab_oshape *__gab_legshpfind(struct gab_eg *self,
 }
 
 GAB_API gab_value *gab_segmodat(struct gab_eg *eg, const char *name) {
-  uint64_t hash = s_char_hash(s_char_cstr(name));
+  uint64_t hash = __gab_hshstr(eg, strlen(name), name);
 
   mtx_lock(&eg->modules_mtx);
 
@@ -2453,7 +2812,7 @@ GAB_API gab_value *gab_segmodat(struct gab_eg *eg, const char *name) {
 
 GAB_API gab_value *gab_segmodput(struct gab_eg *eg, const char *name,
                                  gab_value *module) {
-  uint64_t hash = s_char_hash(s_char_cstr(name));
+  uint64_t hash = __gab_hshstr(eg, strlen(name), name);
 
   mtx_lock(&eg->modules_mtx);
 
@@ -2470,13 +2829,13 @@ GAB_API uint64_t gab_egkeep(struct gab_eg *gab, gab_value v) {
 
 GAB_API uint64_t gab_negkeep(struct gab_eg *gab, uint64_t len,
                              gab_value values[static len]) {
-  mtx_lock(&gab->modules_mtx);
+  mtx_lock(&gab->scratch_mtx);
 
   for (uint64_t i = 0; i < len; i++)
     if (gab_valiso(values[i]))
       v_gab_value_push(&gab->scratch, values[i]);
 
-  mtx_unlock(&gab->modules_mtx);
+  mtx_unlock(&gab->scratch_mtx);
 
   return len;
 }
@@ -2630,15 +2989,52 @@ GAB_INTERNAL uint32_t __gab_utf8_decode(uint32_t *state, uint32_t *codep,
   return *state;
 }
 
-GAB_INTERNAL int __gab_utf8_codepoints(uint8_t *s, uint64_t *count) {
+#define UTF8_HIBITS 0x8080808080808080ull
+
+/*
+ * Count the codepoints in 'len' bytes of 's', or return -1 if they are not
+ * valid utf8.
+ *
+ * Between codepoints, runs of ascii are skipped 32 and then 8 bytes at a time.
+ * Only the bytes of multi-byte codepoints go through the dfa above.
+ */
+GAB_INTERNAL int64_t __gab_utf8_count(const uint8_t *s, uint64_t len) {
   uint32_t codepoint;
   uint32_t state = UTF8_ACCEPT;
+  uint64_t i = 0, count = 0;
 
-  for (*count = 0; *s; ++s)
-    if (!__gab_utf8_decode(&state, &codepoint, *s))
-      *count += 1;
+  while (i < len) {
+    if (state == UTF8_ACCEPT) {
+      while (i + 32 <= len &&
+             !((__gab_hshr8(s + i) | __gab_hshr8(s + i + 8) |
+                __gab_hshr8(s + i + 16) | __gab_hshr8(s + i + 24)) &
+               UTF8_HIBITS))
+        i += 32, count += 32;
+
+      while (i + 8 <= len && !(__gab_hshr8(s + i) & UTF8_HIBITS))
+        i += 8, count += 8;
 
-  return state != UTF8_ACCEPT;
+      if (i == len)
+        break;
+    }
+
+    uint8_t byte = s[i++];
+
+    if (state == UTF8_ACCEPT && byte < 0x80) {
+      count++;
+      continue;
+    }
+
+    switch (__gab_utf8_decode(&state, &codepoint, byte)) {
+    case UTF8_ACCEPT:
+      count++;
+      break;
+    case UTF8_REJECT:
+      return -1;
+    }
+  }
+
+  return state == UTF8_ACCEPT ? count : -1;
 }
 
 GAB_INTERNAL int __gab_utf8_next(uint8_t *s) {
@@ -2820,8 +3216,9 @@ static const char *gab_status_messages[] = {
 GAB_INTERNAL int64_t __gab_spprinterr(struct gab_triple gab, char **buf,
                                       uint64_t *len, struct errdetails *args,
                                       const char *hint) {
+  // The sources table is keyed by identity, so the name must be interned.
   struct gab_src *src =
-      d_gab_src_read(&gab.eg->sources, gab_string(gab, args->src_name));
+      __gab_srcat(gab, gab_strintern(gab, gab_string(gab, args->src_name)));
 
   const char *tok_name =
       src ? gab_token_names[v_gab_token_val_at(&src->tokens, args->token)]
@@ -3328,7 +3725,7 @@ GAB_API struct gab_module_res gab_mresolve(const char **roots,
 
     if (module_path) {
       return (struct gab_module_res){
-          // TODO @cgab @bug: Fix leak
+          // Owned by the caller - see __gab_resfree.
           .path = module_path->data,
           .resource = res,
           .root_path = root,
@@ -3345,9 +3742,92 @@ GAB_API struct gab_module_res gab_mresolve(const char **roots,
   return (struct gab_module_res){0};
 }
 
+/*
+ * 'package:module' and ('package', 'module') resolve to the same thing, so
+ * they share a key. The name is written into DATA, which must hold
+ * __gab_reslen(package, module) + 1 bytes.
+ */
+GAB_INTERNAL uint64_t __gab_reslen(const char *package, const char *module) {
+  uint64_t pkg_len = strlen(package);
+  return module ? pkg_len + 1 + strlen(module) : pkg_len;
+}
+
+GAB_INTERNAL struct gab_reskey __gab_reskey(struct gab_eg *eg, char *data,
+                                            const char *package,
+                                            const char *module) {
+  uint64_t pkg_len = strlen(package);
+  uint64_t len = pkg_len;
+
+  memcpy(data, package, pkg_len);
+
+  if (module) {
+    uint64_t mod_len = strlen(module);
+    data[pkg_len] = ':';
+    memcpy(data + pkg_len + 1, module, mod_len);
+    len += 1 + mod_len;
+  }
+
+  data[len] = '\0';
+
+  return (struct gab_reskey){
+      .hash = __gab_hshstr(eg, len, data),
+      .name = data,
+  };
+}
+
+/*
+ * The path of a resolution is the data of an a_char, allocated by
+ * __gab_resmatch.
+ */
+GAB_INTERNAL void __gab_resfree(struct gab_module_res res) {
+  if (res.path)
+    a_char_destroy((a_char *)(res.path - offsetof(a_char, data)));
+}
+
+/*
+ * Resolving a module checks every resource at every root - which means a
+ * filesystem (or zip) lookup for each. Remember the outcome, including when
+ * nothing was found, so that repeated uses don't touch the filesystem.
+ *
+ * fGAB_USE_RELOAD skips the cache, and replaces what was there.
+ */
 GAB_API struct gab_module_res
 gab_resolve(struct gab_triple gab, const char *package, const char *module) {
-  return gab_mresolve(gab.eg->resroots, gab.eg->res, package, module);
+  struct gab_eg *eg = gab.eg;
+
+  char name[__gab_reslen(package, module) + 1];
+  struct gab_reskey key = __gab_reskey(eg, name, package, module);
+
+  if (!(gab.flags & fGAB_USE_RELOAD)) {
+    mtx_lock(&eg->modules_mtx);
+
+    if (d_gab_resolved_exists(&eg->resolved, key)) {
+      struct gab_module_res res = d_gab_resolved_read(&eg->resolved, key);
+      return mtx_unlock(&eg->modules_mtx), res;
+    }
+
+    mtx_unlock(&eg->modules_mtx);
+  }
+
+  struct gab_module_res res =
+      gab_mresolve(eg->resroots, eg->res, package, module);
+
+  mtx_lock(&eg->modules_mtx);
+
+  if (d_gab_resolved_exists(&eg->resolved, key)) {
+    // Someone else resolved this first, or we are reloading. Either way, the
+    // stored name stays - only the outcome is replaced.
+    uint64_t idx = d_gab_resolved_index_of(&eg->resolved, key);
+    __gab_resfree(d_gab_resolved_ival(&eg->resolved, idx));
+    d_gab_resolved_iset_val(&eg->resolved, idx, res);
+  } else {
+    key.name = strdup(name);
+    d_gab_resolved_insert(&eg->resolved, key, res);
+  }
+
+  mtx_unlock(&eg->modules_mtx);
+
+  return res;
 }
 
 GAB_API union gab_value_pair gab_use(struct gab_triple gab,
@@ -3420,8 +3900,7 @@ GAB_API union gab_value_pair gab_use(struct gab_triple gab,
 
     gab_segmodput(gab.eg, mod.path, result.aresult);
 
-    // TODO @cgab @bug: Fix leak
-    // return a_char_destroy(mod.path), result;
+    // mod.path belongs to the resolution cache.
     return result;
   }
 
@@ -3588,8 +4067,18 @@ GAB_API bool gab_sigterm(struct gab_triple gab) {
   return true;
 }
 
+GAB_INTERNAL bool __gab_gcsignal(struct gab_triple gab,
+                                  enum gab_gctrigger t) {
+  if (!gab_signal(gab, sGAB_COLL, 1))
+    return false;
+
+  atomic_fetch_add_explicit(&gab.eg->gc.stats.triggers[t], 1,
+                            memory_order_relaxed);
+  return true;
+}
+
 GAB_API bool gab_asigcoll(struct gab_triple gab) {
-  return gab_signal(gab, sGAB_COLL, 1);
+  return __gab_gcsignal(gab, kGAB_GCTRIGGER_EXPLICIT);
 }
 
 GAB_API bool gab_sigcoll(struct gab_triple gab) {
@@ -3688,19 +4177,84 @@ GAB_API gab_value gab_type(struct gab_triple gab, enum gab_kind k) {
 
 GAB_API struct gab_gc *gab_gc(struct gab_triple gab) { return &gab.eg->gc; }
 
-GAB_API gab_value gab_thisfiber(struct gab_triple gab) {
-  return q_gab_value_peek(&gab.eg->jobs[gab.wkid].working_queue);
-}
+GAB_API void gab_gcstats(struct gab_triple gab, struct gab_gcstats *out) {
+  struct gab_gctelemetry *stats = &gab.eg->gc.stats;
 
-GAB_API gab_value gab_thisfibmsg(struct gab_triple gab) {
-  return atomic_load(&gab.eg->messages);
-  /*gab_value fiber = gab_thisfiber(gab);*/
-  /**/
-  /*if (fiber == gab_cinvalid)*/
-  /*  return gab_atmat    (gab, gab.eg->messages);*/
-  /**/
-  /*struct gab_ofiber *f =
-        GAB_VAL_TO_FIBER(fiber);*/
+  memset(out, 0, sizeof(struct gab_gcstats));
+
+  for (uint64_t i = 0; i < gab.eg->len; i++) {
+    struct gab_job *job = gab.eg->jobs + i;
+    for (int k = 0; k < kGAB_NKINDS; k++) {
+      out->objects[k] +=
+          atomic_load_explicit(&job->objects[k], memory_order_relaxed);
+      out->bytes[k] += atomic_load_explicit(&job->bytes[k], memory_order_relaxed);
+    }
+
+    out->allocations +=
+        atomic_load_explicit(&job->allocations, memory_order_relaxed);
+    out->allocated_bytes +=
+        atomic_load_explicit(&job->allocated_bytes, memory_order_relaxed);
+  }
+
+  out->collections =
+      atomic_load_explicit(&stats->collections, memory_order_relaxed);
+
+  for (int i = 0; i < kGAB_NGCTRIGGERS; i++)
+    out->triggers[i] =
+        atomic_load_explicit(&stats->triggers[i], memory_order_relaxed);
+
+  out->collect_ns =
+      atomic_load_explicit(&stats->collect_ns, memory_order_relaxed);
+  out->collect_max_ns =
+      atomic_load_explicit(&stats->collect_max_ns, memory_order_relaxed);
+  out->pause_ns = atomic_load_explicit(&stats->pause_ns, memory_order_relaxed);
+  out->pause_max_ns =
+      atomic_load_explicit(&stats->pause_max_ns, memory_order_relaxed);
+
+  for (int i = 0; i < GAB_GCSTATS_NBUCKETS; i++) {
+    out->collect_hist[i] =
+        atomic_load_explicit(&stats->collect_hist[i], memory_order_relaxed);
+    out->pause_hist[i] =
+        atomic_load_explicit(&stats->pause_hist[i], memory_order_relaxed);
+  }
+
+  out->dead = atomic_load_explicit(&stats->dead, memory_order_relaxed);
+  out->overflow_rc =
+      atomic_load_explicit(&stats->overflow_rc, memory_order_relaxed);
+  out->njobs = gab.eg->len;
+}
+
+GAB_API bool gab_gcjobstats(struct gab_triple gab, uint64_t wkid,
+                            struct gab_gcjobstats *out) {
+  if (wkid >= gab.eg->len)
+    return false;
+
+  struct gab_job *job = gab.eg->jobs + wkid;
+
+  out->stack_hwm =
+      atomic_load_explicit(&job->hwm[kGAB_BUF_STK], memory_order_relaxed);
+  out->inc_hwm =
+      atomic_load_explicit(&job->hwm[kGAB_BUF_INC], memory_order_relaxed);
+  out->dec_hwm =
+      atomic_load_explicit(&job->hwm[kGAB_BUF_DEC], memory_order_relaxed);
+  out->young_hwm = atomic_load_explicit(&job->young_hwm, memory_order_relaxed);
+
+  return true;
+}
+
+GAB_API gab_value gab_thisfiber(struct gab_triple gab) {
+  return q_gab_value_peek(&gab.eg->jobs[gab.wkid].working_queue);
+}
+
+GAB_API gab_value gab_thisfibmsg(struct gab_triple gab) {
+  return atomic_load(&gab.eg->messages);
+  /*gab_value fiber = gab_thisfiber(gab);*/
+  /**/
+  /*if (fiber == gab_cinvalid)*/
+  /*  return gab_atmat    (gab, gab.eg->messages);*/
+  /**/
+  /*struct gab_ofiber *f =
+        GAB_VAL_TO_FIBER(fiber);*/
   /*return gab_atmat(gab, f->messages);*/
 }
 
@@ -3893,15 +4447,21 @@ GAB_API inline bool gab_signal(struct gab_triple gab, enum gab_signal s,
       gab, sizeof(struct obj_type) + sizeof(flex_type) * (flex_count),         \
       (kind)))
 
+GAB_INTERNAL void __gab_gcqyoung(struct gab_triple gab, struct gab_obj *obj);
+
 GAB_INTERNAL struct gab_obj *__gab_objcreate(struct gab_triple gab, uint64_t sz,
                                              enum gab_kind k) {
   struct gab_obj *self = gab_egalloc(gab, nullptr, sz);
-  gab.eg->sizes[k] += sz;
-  gab.eg->counts[k]++;
+
+  struct gab_job *job = gab.eg->jobs + gab.wkid;
+  atomic_fetch_add_explicit(&job->objects[k], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&job->bytes[k], sz, memory_order_relaxed);
+  atomic_fetch_add_explicit(&job->allocations, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&job->allocated_bytes, sz, memory_order_relaxed);
 
   self->kind = k;
-  self->references = 1;
   self->flags = fGAB_OBJ_NEW;
+  GAB_OBJ_SETRC(self, 1);
 
 #if cGAB_LOG_GC
   fprintf(stderr, "(%i) CREATE\t%p\t%lu\t%d\n", gab.wkid, (void *)self, sz, k);
@@ -3922,7 +4482,7 @@ GAB_INTERNAL struct gab_obj *__gab_objcreate(struct gab_triple gab, uint64_t sz,
     fprintf(stderr, "(%i) QLOCK\t%p\n", gab.wkid, (void *)self);
 #endif
   } else {
-    gab_dref(gab, __gab_obj(self));
+    __gab_gcqyoung(gab, self);
   }
 
   return self;
@@ -4206,8 +4766,16 @@ GAB_API int64_t gab_fvalinspect(FILE *stream, gab_value self, int depth) {
 }
 
 GAB_API void __gab_objdestroy(struct gab_triple gab, struct gab_obj *self) {
-  gab.eg->sizes[self->kind] -= __gab_objsize(self);
-  gab.eg->counts[self->kind]--;
+  // Fibers change their kind as they run - count them against the kind they
+  // were created with.
+  enum gab_kind k = self->kind;
+  if (k == kGAB_FIBERRUNNING || k == kGAB_FIBERDONE)
+    k = kGAB_FIBER;
+
+  struct gab_job *job = gab.eg->jobs + gab.wkid;
+  atomic_fetch_sub_explicit(&job->objects[k], 1, memory_order_relaxed);
+  atomic_fetch_sub_explicit(&job->bytes[k], __gab_objsize(self),
+                            memory_order_relaxed);
 
   switch (self->kind) {
   case kGAB_FIBER:
@@ -4240,7 +4808,10 @@ GAB_API void __gab_objdestroy(struct gab_triple gab, struct gab_obj *self) {
   case kGAB_STRING: {
     gab_verify(mtx_trylock(&gab.eg->gc_mtx) == thrd_busy,
                "This thread must be holding the gc_mtx already.");
-    d_strings_remove(&gab.eg->strings, (struct gab_ostring *)self);
+    if (atomic_load(&((struct gab_ostring *)self)->interned))
+      d_strings_remove(&gab.eg->strings, (struct gab_ostring *)self);
+
+    free(atomic_load(&((struct gab_ostring *)self)->index));
     // gab_assert(removed, "Must succeed in removing string");
     break;
   }
@@ -4303,11 +4874,10 @@ GAB_INTERNAL gab_value __gab_nstring(struct gab_triple gab, uint64_t hash,
   memcpy(self->data, str.data, str.len * sizeof(char));
   self->len = str.len;
   self->hash = hash;
+  atomic_init(&self->interned, false);
+  atomic_init(&self->index, nullptr);
 
-  uint64_t count = 0;
-  bool pass = !__gab_utf8_codepoints((uint8_t *)self->data, &count);
-
-  self->mb_len = pass ? count : -1;
+  self->mb_len = __gab_utf8_count((uint8_t *)self->data, self->len);
 
   return __gab_obj(self);
 }
@@ -4317,14 +4887,13 @@ GAB_API gab_value gab_tnstring(struct gab_triple gab, uint64_t len,
   if (len <= 5)
     return gab_shorstr(len, data);
 
-#if cGAB_STRING_HASHLEN > 0
-  uint64_t hash =
-      __gab_hshbytes(len < cGAB_STRING_HASHLEN ? len : cGAB_STRING_HASHLEN,
-                     (unsigned char *)data);
-#else
-  uint64_t hash = hash_bytes(len, (unsigned char *)data);
+#if cGAB_STRING_INTERN_MAX > 0
+  if (len > cGAB_STRING_INTERN_MAX)
+    return gab_nbigstring(gab, len, data);
 #endif
 
+  uint64_t hash = __gab_hshstr(gab.eg, len, data);
+
   switch (mtx_trylock(&gab.eg->gc_mtx)) {
   case thrd_success:
     break;
@@ -4372,6 +4941,7 @@ GAB_API gab_value gab_tnstring(struct gab_triple gab, uint64_t len,
     return gab_cinvalid;
   }
 
+  atomic_store(&GAB_VAL_TO_STRING(s)->interned, true);
   d_strings_insert(&gab.eg->strings, GAB_VAL_TO_STRING(s), 0);
 
   mtx_unlock(&gab.eg->gc_mtx);
@@ -4379,6 +4949,15 @@ GAB_API gab_value gab_tnstring(struct gab_triple gab, uint64_t len,
   return s;
 }
 
+GAB_API gab_value gab_nbigstring(struct gab_triple gab, uint64_t len,
+                                 const char *data) {
+  if (len <= 5)
+    return gab_shorstr(len, data);
+
+  // Without the intern table there is no lock to wait on.
+  return __gab_nstring(gab, __gab_hshstr(gab.eg, len, data), len, data);
+}
+
 GAB_API gab_value gab_nstring(struct gab_triple gab, uint64_t len,
                               const char *data) {
   for (;;) {
@@ -4471,12 +5050,29 @@ GAB_API uint64_t gab_strmblen(gab_value str) {
     return GAB_VAL_TO_STRING(str)->mb_len;
 
   // This is a small string. No space to store mb_len, so just recompute.
-  uint64_t count = 0;
-  bool pass = !__gab_utf8_codepoints((uint8_t *)&str, &count);
-
-  return pass ? count : -1;
+  return __gab_utf8_count((uint8_t *)gab_strdata(&str), gab_strlen(str));
 };
 
+GAB_API bool gab_strisascii(gab_value str) {
+  return gab_strmblen(str) == gab_strlen(str);
+}
+
+GAB_API void *gab_strindex(gab_value str) {
+  if (!gab_valiso(str))
+    return nullptr;
+
+  return atomic_load(&GAB_VAL_TO_STRING(str)->index);
+}
+
+GAB_API bool gab_strsetindex(gab_value str, void *index) {
+  if (!gab_valiso(str))
+    return false;
+
+  void *expected = nullptr;
+  return atomic_compare_exchange_strong(&GAB_VAL_TO_STRING(str)->index,
+                                        &expected, index);
+}
+
 GAB_API uint64_t gab_strhash(gab_value str) {
   gab_precondition(gab_valkind(str) == kGAB_STRING ||
                        gab_valkind(str) == kGAB_BINARY,
@@ -4529,12 +5125,13 @@ GAB_API gab_value gab_tstrcat(struct gab_triple gab, gab_value _a,
   memcpy(buff->data + alen, gab_strdata(&_b), blen);
 
 // Pre compute the hash
-#if cGAB_STRING_HASHLEN > 0
-  uint64_t hash =
-      __gab_hshbytes(len < cGAB_STRING_HASHLEN ? len : cGAB_STRING_HASHLEN,
-                     (unsigned char *)buff->data);
-#else
-  uint64_t hash = hash_bytes(len, (unsigned char *)buff->data);
+  uint64_t hash = __gab_hshstr(gab.eg, len, buff->data);
+
+#if cGAB_STRING_INTERN_MAX > 0
+  if (len > cGAB_STRING_INTERN_MAX) {
+    gab_value result = __gab_nstring(gab, hash, len, buff->data);
+    return a_char_destroy(buff), result;
+  }
 #endif
 
   /*
@@ -4575,6 +5172,7 @@ GAB_API gab_value gab_tstrcat(struct gab_triple gab, gab_value _a,
     return gab_cinvalid;
   }
 
+  atomic_store(&GAB_VAL_TO_STRING(result)->interned, true);
   d_strings_insert(&gab.eg->strings, GAB_VAL_TO_STRING(result), 0);
 
   mtx_unlock(&gab.eg->gc_mtx);
@@ -4623,6 +5221,11 @@ GAB_API gab_value gab_prtenv(gab_value prt) {
   return GAB_VAL_TO_PROTOTYPE(prt)->env;
 }
 
+GAB_API uint64_t gab_prtlen(gab_value prt) {
+  assert(gab_valkind(prt) == kGAB_PROTOTYPE);
+  return GAB_VAL_TO_PROTOTYPE(prt)->len;
+}
+
 GAB_API gab_value gab_prtparams(struct gab_triple gab, gab_value prt) {
   assert(gab_valkind(prt) == kGAB_PROTOTYPE);
   gab_value shp = gab_prtshp(prt);
@@ -5028,6 +5631,18 @@ GAB_API uint64_t gab_shpfind(gab_value shape, gab_value key) {
                    "Invalid kind %u", gab_valkind(shape));
   gab_value node = shape;
 
+  // Keys are interned, so a string that isn't can only be found by its
+  // contents.
+  if (__gab_unlikely(__gab_strisloose(key))) {
+    uint64_t len = gab_shplen(shape);
+
+    for (uint64_t i = 0; i < len; i++)
+      if (__gab_valequal(gab_ushpat(shape, i), key))
+        return i;
+
+    return -1;
+  }
+
   for (uint64_t shift = 0;; shift = __gab_shpishift(shift)) {
     uint32_t midx = __gab_shpmidx(key, shift);
     uint64_t sidx = __gab_shpnth(node, midx);
@@ -6170,8 +6785,18 @@ GAB_API gab_value gab_tshape(struct gab_triple gab, uint64_t stride,
   gab_value newdata[len + 1];
   uint64_t newlen = __gab_shpprepkeys(stride, len, data, newdata);
 
+  // Shapes compare their keys by identity, so keys must be interned.
+  for (uint64_t i = 0; i < newlen; i++) {
+    gab_value key = __gab_strintern(gab, newdata[i]);
+
+    if (key == gab_ctimeout || key == gab_cinvalid)
+      return key;
+
+    newdata[i] = key;
+  }
+
   // TODO @cgab @bug: Handle duplicate keys correctly.
-  uint64_t hash = __gab_hshwords(newlen, newdata);
+  uint64_t hash = __gab_hshwords(gab.eg->hash_seed, newlen, newdata);
 
   switch (mtx_trylock(&gab.eg->gc_mtx)) {
   case thrd_success:
@@ -6356,7 +6981,7 @@ GAB_API gab_value gab_tshpwithout(struct gab_triple gab, gab_value shape,
   if (!found)
     return shape;
 
-  uint64_t hash = __gab_hshwords(newlen, newdata);
+  uint64_t hash = __gab_hshwords(gab.eg->hash_seed, newlen, newdata);
 
   switch (mtx_trylock(&gab.eg->gc_mtx)) {
   case thrd_success:
@@ -6454,6 +7079,11 @@ GAB_API gab_value gab_tshpwith(struct gab_triple gab, gab_value shp,
 
   struct gab_oshape *s = GAB_VAL_TO_SHAPE(shp);
 
+  key = __gab_strintern(gab, key);
+
+  if (key == gab_ctimeout || key == gab_cinvalid)
+    return key;
+
   uint64_t idx = gab_shpfind(shp, key);
   if (idx != -1)
     return shp;
@@ -6586,6 +7216,12 @@ GAB_INTERNAL gab_value __gab_fibsetup(struct gab_triple gab,
 GAB_API gab_value gab_fiber(struct gab_triple gab, struct gab_fiber_argt args) {
   gab_precondition(gab_valkind(args.message) == kGAB_MESSAGE, "Invalid kind");
 
+  // The fiber's send is cached by message identity.
+  args.message = gab_strintern(gab, args.message);
+
+  if (args.message == gab_cinvalid)
+    return gab_cinvalid;
+
   struct gab_ofiber *self =
       GAB_CREATE_FLEX_OBJ(gab_ofiber, gab_value, args.argc + 2, kGAB_FIBER);
 
@@ -7427,6 +8063,15 @@ GAB_INTERNAL uint64_t __gab_insdump(FILE *stream, struct gab_oprototype *self,
     return __gab_insdumpnconstant(stream, self, offset, false);
   case OP_TUPLE_CONSTANT:
   case OP_CONSTANT:
+  case OP_CONSTANT_SEND_PRIMITIVE_ADD:
+  case OP_CONSTANT_SEND_PRIMITIVE_SUB:
+  case OP_CONSTANT_SEND_PRIMITIVE_DIV:
+  case OP_CONSTANT_SEND_PRIMITIVE_MUL:
+  case OP_CONSTANT_SEND_PRIMITIVE_MOD:
+  case OP_CONSTANT_SEND_PRIMITIVE_LT:
+  case OP_CONSTANT_SEND_PRIMITIVE_LTE:
+  case OP_CONSTANT_SEND_PRIMITIVE_GT:
+  case OP_CONSTANT_SEND_PRIMITIVE_GTE:
     return __gab_insdumpconstant(stream, self, offset, false);
   case OP_NTUPLE_CONSTANT:
     return __gab_insdumpconstant(stream, self, offset, true);
@@ -7436,6 +8081,7 @@ GAB_INTERNAL uint64_t __gab_insdump(FILE *stream, struct gab_oprototype *self,
   case OP_SEND_BLOCK:
   case OP_SEND_NATIVE:
   case OP_SEND_PROPERTY:
+  case OP_SEND_ARGUMENT:
   case OP_SEND_PRIMITIVE_CONCAT:
   case OP_SEND_PRIMITIVE_SPLATLIST:
   case OP_SEND_PRIMITIVE_SPLATDICT:
@@ -7457,6 +8103,8 @@ GAB_INTERNAL uint64_t __gab_insdump(FILE *stream, struct gab_oprototype *self,
   case OP_LOCALTAILSEND_BLOCK:
   case OP_MATCHSEND_BLOCK:
   case OP_MATCHTAILSEND_BLOCK:
+  case OP_MATCHSEND_BOOL:
+  case OP_MATCHTAILSEND_BOOL:
     return __gab_insdumpsend(stream, self, offset);
   case OP_NTUPLE:
   case OP_POP_N:
@@ -8436,8 +9084,7 @@ GAB_INTERNAL a_char *__gab_prsstrraw(struct parser *parser, s_char raw_str) {
 
   buffer[buf_end] = '\0';
 
-  uint64_t count;
-  gab_assert(!__gab_utf8_codepoints((uint8_t *)buffer, &count),
+  gab_assert(__gab_utf8_count((uint8_t *)buffer, buf_end) != -1,
              "The buffer %.*s should be valid utf8-encoded", (int)buf_end,
              (char *)buffer);
 
@@ -8854,7 +9501,7 @@ GAB_INTERNAL gab_value __gab_prsmsg(struct gab_triple gab,
                                     struct parser *parser, gab_value lhs) {
   gab_value id = __gab_tbprsprevid(gab, parser);
 
-  return __gab_nodeval(gab, gab_strtomsg(id));
+  return __gab_nodeval(gab, gab_strtomsg(gab_strintern(gab, id)));
 }
 
 GAB_INTERNAL gab_value __gab_prssym(struct gab_triple gab,
@@ -9160,18 +9807,19 @@ GAB_INTERNAL gab_value __gab_parse(struct gab_triple gab,
   return ast;
 }
 
-GAB_API union gab_value_pair gab_parse(struct gab_triple gab,
-                                       struct gab_parse_argt args) {
-  gab.flags |= args.flags;
-
-  args.name = args.name ? args.name : "__main__";
-
-  gab_value name = gab_string(gab, args.name);
+GAB_INTERNAL struct gab_src *__gab_parsesrc(struct gab_triple gab,
+                                            struct gab_parse_argt args) {
+  // The sources table is keyed by identity, so the name must be interned.
+  gab_value name =
+      gab_strintern(gab, gab_string(gab, args.name ? args.name : "__main__"));
 
-  struct gab_src *src =
-      __gab_source(gab, name, (char *)args.source,
-                   args.source_len ? args.source_len : strlen(args.source) + 1);
+  return __gab_source(gab, name, (char *)args.source,
+                      args.source_len ? args.source_len
+                                      : strlen(args.source) + 1);
+}
 
+GAB_INTERNAL union gab_value_pair __gab_parsewith(struct gab_triple gab,
+                                                 struct gab_src *src) {
   struct parser parser = {.src = src, .err = gab_cundefined};
 
   gab_value ast = __gab_parse(gab, &parser);
@@ -9186,6 +9834,312 @@ GAB_API union gab_value_pair gab_parse(struct gab_triple gab,
     return (union gab_value_pair){.status = gab_cvalid, .vresult = ast};
 }
 
+GAB_API union gab_value_pair gab_parse(struct gab_triple gab,
+                                       struct gab_parse_argt args) {
+  gab.flags |= args.flags;
+
+  struct gab_src *src = __gab_parsesrc(gab, args);
+
+  __gab_srcacquire(gab, src);
+
+  union gab_value_pair ast = __gab_parsewith(gab, src);
+
+  return __gab_srcrelease(src), ast;
+}
+
+/*
+ * AST OPTIMIZATION
+ *
+ * When fGAB_OPTIMIZE is set, gab_build rewrites a parsed AST before handing it
+ * to the bytecode compiler:
+ *
+ *  - Binary primitive sends between literal numbers, and concatenation of
+ *    literal strings, are folded into their result.
+ *
+ *  - Tuples in a block which only contain literals have no effect (unless they
+ *    are the block's result). They are dropped, along with the trim that would
+ *    have discarded them.
+ *
+ *  - A local which is bound exactly once in its scope, to a single literal, is
+ *    replaced by that literal wherever it is read after the binding. Reads
+ *    within nested blocks (::) are left alone - these are captures.
+ *
+ * Folding assumes the primitive specializations of numbers and strings haven't
+ * been redefined.
+ */
+struct optimizer {
+  struct gab_triple gab;
+  struct gab_src *src;
+  // Every name bound in the current scope - once per binding.
+  v_gab_value bound;
+  // Pairs of [name, literal] for the locals which may be propagated.
+  v_gab_value consts;
+};
+
+GAB_INTERNAL gab_value __gab_opttup(struct optimizer *o, gab_value tup);
+
+GAB_INTERNAL bool __gab_optisliteral(gab_value v) {
+  switch (gab_valkind(v)) {
+  case kGAB_NUMBER:
+  case kGAB_STRING:
+  case kGAB_MESSAGE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+GAB_INTERNAL bool __gab_optisliterals(gab_value tup) {
+  uint64_t len = gab_reclen(tup);
+
+  for (uint64_t i = 0; i < len; i++)
+    if (!__gab_optisliteral(gab_uvrecat(tup, i)))
+      return false;
+
+  return true;
+}
+
+GAB_INTERNAL void __gab_optbind(struct optimizer *o, gab_value bindings) {
+  uint64_t len = gab_reclen(bindings);
+
+  for (uint64_t i = 0; i < len; i++) {
+    gab_value binding = gab_uvrecat(bindings, i);
+
+    switch (gab_valkind(binding)) {
+    case kGAB_BINARY:
+      v_gab_value_push(&o->bound, binding);
+      break;
+    case kGAB_RECORD:
+      // Splatted bindings, ie: (a b*) := ...
+      if (gab_valkind(gab_recshp(binding)) == kGAB_SHAPE) {
+        gab_value lhs = gab_mrecat(o->gab, binding, mGAB_AST_NODE_SEND_LHS);
+        if (gab_reclen(lhs) > 0)
+          v_gab_value_push(&o->bound, gab_uvrecat(lhs, 0));
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/*
+ * Collect every binding made in the current scope. Nested blocks (::) are
+ * their own scope, so they are skipped.
+ */
+GAB_INTERNAL void __gab_optscan(struct optimizer *o, gab_value tup) {
+  uint64_t len = gab_reclen(tup);
+
+  for (uint64_t i = 0; i < len; i++) {
+    gab_value node = gab_uvrecat(tup, i);
+
+    if (gab_valkind(node) != kGAB_RECORD)
+      continue;
+
+    if (gab_valkind(gab_recshp(node)) == kGAB_SHAPELIST) {
+      uint64_t nchildren = gab_reclen(node);
+
+      for (uint64_t j = 0; j < nchildren; j++)
+        __gab_optscan(o, gab_uvrecat(node, j));
+
+      continue;
+    }
+
+    gab_value lhs = gab_mrecat(o->gab, node, mGAB_AST_NODE_SEND_LHS);
+    gab_value msg = gab_mrecat(o->gab, node, mGAB_AST_NODE_SEND_MSG);
+    gab_value rhs = gab_mrecat(o->gab, node, mGAB_AST_NODE_SEND_RHS);
+
+    if (msg == gab_binary(o->gab, (uint8_t *)mGAB_BLOCK))
+      continue;
+
+    if (msg == gab_binary(o->gab, (uint8_t *)mGAB_ASSIGN))
+      __gab_optbind(o, lhs);
+    else
+      __gab_optscan(o, lhs);
+
+    __gab_optscan(o, rhs);
+  }
+}
+
+GAB_INTERNAL uint64_t __gab_optnbound(struct optimizer *o, gab_value name) {
+  uint64_t n = 0;
+
+  for (uint64_t i = 0; i < o->bound.len; i++)
+    if (__gab_valequal(v_gab_value_val_at(&o->bound, i), name))
+      n++;
+
+  return n;
+}
+
+GAB_INTERNAL gab_value __gab_optconst(struct optimizer *o, gab_value name) {
+  for (uint64_t i = 0; i < o->consts.len; i += 2)
+    if (__gab_valequal(v_gab_value_val_at(&o->consts, i), name))
+      return v_gab_value_val_at(&o->consts, i + 1);
+
+  return gab_cundefined;
+}
+
+GAB_INTERNAL gab_value __gab_optfold(struct optimizer *o, gab_value msg,
+                                     gab_value lhs, gab_value rhs) {
+  if (gab_reclen(lhs) != 1 || gab_reclen(rhs) != 1)
+    return gab_cundefined;
+
+  struct gab_triple gab = o->gab;
+  gab_value a = gab_uvrecat(lhs, 0);
+  gab_value b = gab_uvrecat(rhs, 0);
+
+  if (gab_valkind(a) == kGAB_STRING && gab_valkind(b) == kGAB_STRING)
+    return msg == gab_message(gab, mGAB_ADD) ? gab_strcat(gab, a, b)
+                                             : gab_cundefined;
+
+  if (gab_valkind(a) != kGAB_NUMBER || gab_valkind(b) != kGAB_NUMBER)
+    return gab_cundefined;
+
+  gab_float x = gab_valtof(a), y = gab_valtof(b);
+
+  if (msg == gab_message(gab, mGAB_ADD))
+    return gab_number(x + y);
+  if (msg == gab_message(gab, mGAB_SUB))
+    return gab_number(x - y);
+  if (msg == gab_message(gab, mGAB_MUL))
+    return gab_number(x * y);
+  if (msg == gab_message(gab, mGAB_DIV))
+    return gab_number(x / y);
+  if (msg == gab_message(gab, mGAB_LT))
+    return gab_bool(x < y);
+  if (msg == gab_message(gab, mGAB_LTE))
+    return gab_bool(x <= y);
+  if (msg == gab_message(gab, mGAB_GT))
+    return gab_bool(x > y);
+  if (msg == gab_message(gab, mGAB_GTE))
+    return gab_bool(x >= y);
+
+  return gab_cundefined;
+}
+
+GAB_INTERNAL gab_value __gab_optscope(struct gab_triple gab,
+                                      struct gab_src *src, gab_value ast) {
+  struct optimizer o = {.gab = gab, .src = src};
+
+  __gab_optscan(&o, ast);
+
+  gab_value res = __gab_opttup(&o, ast);
+
+  v_gab_value_destroy(&o.bound);
+  v_gab_value_destroy(&o.consts);
+
+  return res;
+}
+
+GAB_INTERNAL gab_value __gab_optsend(struct optimizer *o, gab_value node) {
+  static const char *keys[] = {
+      mGAB_AST_NODE_SEND_LHS,
+      mGAB_AST_NODE_SEND_MSG,
+      mGAB_AST_NODE_SEND_RHS,
+  };
+
+  gab_value lhs = gab_mrecat(o->gab, node, mGAB_AST_NODE_SEND_LHS);
+  gab_value msg = gab_mrecat(o->gab, node, mGAB_AST_NODE_SEND_MSG);
+  gab_value rhs = gab_mrecat(o->gab, node, mGAB_AST_NODE_SEND_RHS);
+
+  gab_value vals[] = {lhs, msg, rhs};
+
+  if (msg == gab_binary(o->gab, (uint8_t *)mGAB_BLOCK)) {
+    // The body of a block is a new scope. Its arguments are left untouched.
+    vals[2] = __gab_optscope(o->gab, o->src, rhs);
+  } else if (msg == gab_binary(o->gab, (uint8_t *)mGAB_ASSIGN)) {
+    vals[2] = __gab_opttup(o, rhs);
+
+    gab_value name = gab_reclen(lhs) == 1 ? gab_uvrecat(lhs, 0) : gab_cinvalid;
+
+    if (gab_valkind(name) == kGAB_BINARY && gab_reclen(vals[2]) == 1 &&
+        __gab_optisliteral(gab_uvrecat(vals[2], 0)) &&
+        __gab_optnbound(o, name) == 1)
+      v_gab_value_push(&o->consts, name),
+          v_gab_value_push(&o->consts, gab_uvrecat(vals[2], 0));
+  } else {
+    vals[0] = __gab_opttup(o, lhs);
+    vals[2] = __gab_opttup(o, rhs);
+
+    gab_value folded = __gab_optfold(o, msg, vals[0], vals[2]);
+
+    if (folded != gab_cundefined)
+      return folded;
+  }
+
+  if (vals[0] == lhs && vals[2] == rhs)
+    return node;
+
+  gab_value res = gab_mrecord(o->gab, 1, 3, keys, vals);
+  return __gab_nodeinfosteal(o->src, node, res);
+}
+
+GAB_INTERNAL gab_value __gab_optblock(struct optimizer *o, gab_value node) {
+  uint64_t len = gab_reclen(node);
+
+  v_gab_value children = {0};
+  bool changed = false;
+
+  for (uint64_t i = 0; i < len; i++) {
+    gab_value child = gab_uvrecat(node, i);
+    gab_value res = __gab_opttup(o, child);
+
+    changed |= res != child;
+
+    if (i != len - 1 && __gab_optisliterals(res)) {
+      changed = true;
+      continue;
+    }
+
+    v_gab_value_push(&children, res);
+  }
+
+  gab_value res = node;
+
+  if (changed) {
+    res = gab_list(o->gab, 1, children.len, children.data);
+    __gab_nodeinfosteal(o->src, node, res);
+  }
+
+  v_gab_value_destroy(&children);
+  return res;
+}
+
+GAB_INTERNAL gab_value __gab_optval(struct optimizer *o, gab_value node) {
+  switch (gab_valkind(node)) {
+  case kGAB_BINARY: {
+    gab_value k = __gab_optconst(o, node);
+    return k == gab_cundefined ? node : k;
+  }
+  case kGAB_RECORD:
+    if (gab_valkind(gab_recshp(node)) == kGAB_SHAPELIST)
+      return __gab_optblock(o, node);
+
+    return __gab_optsend(o, node);
+  default:
+    return node;
+  }
+}
+
+GAB_INTERNAL gab_value __gab_opttup(struct optimizer *o, gab_value tup) {
+  uint64_t len = gab_reclen(tup);
+
+  gab_value vals[len + 1];
+  bool changed = false;
+
+  for (uint64_t i = 0; i < len; i++) {
+    gab_value val = gab_uvrecat(tup, i);
+    vals[i] = __gab_optval(o, val);
+    changed |= vals[i] != val;
+  }
+
+  if (!changed)
+    return tup;
+
+  gab_value res = gab_list(o->gab, 1, len, vals);
+  return __gab_nodeinfosteal(o->src, tup, res);
+}
+
 /* ----------------------------------------
  * SECTION 4              BYTECODE COMPILER
  *
@@ -9438,6 +10392,36 @@ struct super_instruction super_instructions[] = {
 
 const int nsuper_instructions = LEN_CARRAY(super_instructions);
 
+static_assert(LEN_CARRAY(super_instructions) < UINT8_MAX,
+              "Super instructions shall be indexable by a byte");
+
+/*
+ * (index + 1) into super_instructions for each pair of (prev_op, op), or 0
+ * if the pair doesn't form a super instruction. Filled in once per process,
+ * by the first gab_create, so that emitting an instruction is a single lookup.
+ */
+static uint8_t super_instruction_at[LEN_CARRAY(gab_opcode_names)]
+                                   [LEN_CARRAY(gab_opcode_names)];
+
+static once_flag super_instruction_once = ONCE_FLAG_INIT;
+
+static void __gab_bcsuperfill(void) {
+  // Walk backwards so that earlier entries take precedence, as they did when
+  // the table was scanned in order.
+  for (int i = nsuper_instructions - 1; i >= 0; i--) {
+    struct super_instruction si = super_instructions[i];
+    super_instruction_at[si.from][si.via] = i + 1;
+  }
+}
+
+/*
+ * Engines may be created concurrently, while another engine's compiler is
+ * reading the table - so it is only ever written once.
+ */
+GAB_INTERNAL void __gab_bcsuperinit() {
+  call_once(&super_instruction_once, __gab_bcsuperfill);
+}
+
 struct inst_arg {
   uint8_t op;
 
@@ -9560,80 +10544,79 @@ GAB_INTERNAL void __gab_bcmulti_short_arg_append(struct bc *bc,
 GAB_INTERNAL void __gab_ibcpush(struct bc *bc, struct inst_arg arg,
                                 gab_value node) {
 #if cGAB_SUPERINSTRUCTIONS
-  for (int i = 0; i < nsuper_instructions; i++) {
-    struct super_instruction si = super_instructions[i];
+  uint8_t si_at = super_instruction_at[bc->prev_op][arg.op];
 
-    if (si.from == bc->prev_op && si.via == arg.op) {
+  if (si_at) {
+    struct super_instruction si = super_instructions[si_at - 1];
 
-      switch (si.k) {
-      default:
-        gab_unreachable("Invalid superinstruction kind");
+    switch (si.k) {
+    default:
+      gab_unreachable("Invalid superinstruction kind");
+      break;
+    case kSI_REPLACE: {
+      // Push the arg for this new instruction
+      switch (arg.k) {
+      case kINST_ARG_NONE:
         break;
-      case kSI_REPLACE: {
-        // Push the arg for this new instruction
-        switch (arg.k) {
-        case kINST_ARG_NONE:
-          break;
-        case kINST_ARG_BYTE:
-          __gab_bbcpush(bc, arg.as.byte_arg, node);
-          break;
-        case kINST_ARG_SHORT:
-          __gab_sbcpush(bc, arg.as.short_arg, node);
-          break;
-        }
-
-        // Update the old instruction to the new, and the previous op.
-        v_uint8_t_set(&bc->bc, bc->prev_op_at, si.to);
-        bc->prev_op = si.to;
+      case kINST_ARG_BYTE:
+        __gab_bbcpush(bc, arg.as.byte_arg, node);
+        break;
+      case kINST_ARG_SHORT:
+        __gab_sbcpush(bc, arg.as.short_arg, node);
         break;
       }
-      case kSI_MAKE_MULTI: {
-        // Push a 2, to include previous op and this repetition.
-        __gab_bbcpush(bc, 2, node);
 
-        // Update the instruction to the repeatable target.
-        v_uint8_t_set(&bc->bc, bc->prev_op_at, si.to);
-        bc->prev_op = si.to;
+      // Update the old instruction to the new, and the previous op.
+      v_uint8_t_set(&bc->bc, bc->prev_op_at, si.to);
+      bc->prev_op = si.to;
+      break;
+    }
+    case kSI_MAKE_MULTI: {
+      // Push a 2, to include previous op and this repetition.
+      __gab_bbcpush(bc, 2, node);
 
-        break;
-      }
-      case kSI_MULTI_APPEND: {
-        uint64_t multi_arg = bc->prev_op_at + 1;
-        uint8_t multi = v_uint8_t_val_at(&bc->bc, multi_arg);
+      // Update the instruction to the repeatable target.
+      v_uint8_t_set(&bc->bc, bc->prev_op_at, si.to);
+      bc->prev_op = si.to;
 
-        // Increment the multi-arg count.
-        v_uint8_t_set(&bc->bc, multi_arg, multi + 1);
+      break;
+    }
+    case kSI_MULTI_APPEND: {
+      uint64_t multi_arg = bc->prev_op_at + 1;
+      uint8_t multi = v_uint8_t_val_at(&bc->bc, multi_arg);
 
-        // Leave the instruction, as we are just adding a repetition
-        break;
-      }
-      case kSI_BYTE_ARG_MAKE_MULTI:
-        __gab_bcbyte_arg_make_multi(bc, arg, si, node, 1);
-        break;
-      case kSI_BYTE_ARG_MAKE_MULTI2:
-        __gab_bcbyte_arg_make_multi(bc, arg, si, node, 2);
-        break;
-      case kSI_MULTI_BYTE_ARG_APPEND:
-        __gab_bcmulti_byte_arg_append(bc, arg, si, node, 1);
-        break;
-      case kSI_MULTI2_BYTE_ARG_APPEND:
-        __gab_bcmulti_byte_arg_append(bc, arg, si, node, 2);
-        break;
-      case kSI_SHORT_ARG_MAKE_MULTI:
-        __gab_bcshort_arg_make_multi(bc, arg, si, node, 1);
-        break;
-      case kSI_SHORT_ARG_MAKE_MULTI2:
-        __gab_bcshort_arg_make_multi(bc, arg, si, node, 2);
-        break;
-      case kSI_MULTI_SHORT_ARG_APPEND:
-        __gab_bcmulti_short_arg_append(bc, arg, si, node, 1);
-        break;
-      case kSI_MULTI2_SHORT_ARG_APPEND:
-        __gab_bcmulti_short_arg_append(bc, arg, si, node, 2);
-        break;
-      };
-      return;
+      // Increment the multi-arg count.
+      v_uint8_t_set(&bc->bc, multi_arg, multi + 1);
+
+      // Leave the instruction, as we are just adding a repetition
+      break;
     }
+    case kSI_BYTE_ARG_MAKE_MULTI:
+      __gab_bcbyte_arg_make_multi(bc, arg, si, node, 1);
+      break;
+    case kSI_BYTE_ARG_MAKE_MULTI2:
+      __gab_bcbyte_arg_make_multi(bc, arg, si, node, 2);
+      break;
+    case kSI_MULTI_BYTE_ARG_APPEND:
+      __gab_bcmulti_byte_arg_append(bc, arg, si, node, 1);
+      break;
+    case kSI_MULTI2_BYTE_ARG_APPEND:
+      __gab_bcmulti_byte_arg_append(bc, arg, si, node, 2);
+      break;
+    case kSI_SHORT_ARG_MAKE_MULTI:
+      __gab_bcshort_arg_make_multi(bc, arg, si, node, 1);
+      break;
+    case kSI_SHORT_ARG_MAKE_MULTI2:
+      __gab_bcshort_arg_make_multi(bc, arg, si, node, 2);
+      break;
+    case kSI_MULTI_SHORT_ARG_APPEND:
+      __gab_bcmulti_short_arg_append(bc, arg, si, node, 1);
+      break;
+    case kSI_MULTI2_SHORT_ARG_APPEND:
+      __gab_bcmulti_short_arg_append(bc, arg, si, node, 2);
+      break;
+    };
+    return;
   }
 #endif
 
@@ -9748,6 +10731,9 @@ GAB_INTERNAL void __gab_bcsend(struct gab_triple gab, struct bc *bc,
   gab_precondition(gab_valkind(m) == kGAB_MESSAGE,
                    "Invalid kind for message send");
 
+  // Send caches hash and compare messages by identity.
+  m = gab_strintern(gab, m);
+
   uint16_t ks = __gab_bcaddk(gab, bc, m);
   __gab_bcaddk(gab, bc, gab_cinvalid);
 
@@ -10549,7 +11535,7 @@ GAB_API union gab_value_pair gab_compile(struct gab_triple gab,
                    "ENV shall be a record");
   gab.flags |= args.flags;
 
-  struct gab_src *src = d_gab_src_read(&gab.eg->sources, args.mod);
+  struct gab_src *src = __gab_srcat(gab, gab_strintern(gab, args.mod));
 
   if (src == nullptr)
     return (union gab_value_pair){{gab_cinvalid, gab_cinvalid}};
@@ -10662,19 +11648,22 @@ GAB_API union gab_value_pair gab_build(struct gab_triple gab,
 
   gab_value mod = gab_string(gab, args.name);
 
-  union gab_value_pair ast = gab_parse(gab, args);
-
-  gab_assert(ast.vresult != gab_cundefined, "Shall have vresult in all cases");
-
-  if (ast.status != gab_cvalid)
-    return ast;
-
-  struct gab_src *src = d_gab_src_read(&gab.eg->sources, mod);
+  struct gab_src *src = __gab_parsesrc(gab, args);
 
   if (src == nullptr)
     return (union gab_value_pair){.status = gab_cinvalid,
                                                      .vresult = gab_cundefined};
 
+  // Hold the source from parsing through to completion.
+  __gab_srcacquire(gab, src);
+
+  union gab_value_pair ast = __gab_parsewith(gab, src);
+
+  gab_assert(ast.vresult != gab_cundefined, "Shall have vresult in all cases");
+
+  if (ast.status != gab_cvalid)
+    return __gab_srcrelease(src), ast;
+
   gab_gclock(gab);
 
   // Default to empty list here
@@ -10695,7 +11684,20 @@ GAB_API union gab_value_pair gab_build(struct gab_triple gab,
       gab, gab_recordof(gab, gab_binary(gab, (uint8_t *)"self"), gab_nil));
 
   if (ast.status == gab_cinvalid)
-    return gab_gcunlock(gab), ast;
+    return __gab_srcrelease(src), gab_gcunlock(gab), ast;
+
+  if (gab.flags & fGAB_OPTIMIZE) {
+    gab_value optimized = __gab_optscope(gab, src, ast.vresult);
+
+    if (optimized != ast.vresult) {
+      gab_iref(gab, optimized);
+      gab_egkeep(gab.eg, optimized);
+      ast.vresult = optimized;
+    }
+
+    if (gab.flags & fGAB_AST_DUMP)
+      gab_fprintf(stdout, "$\n", gab_pvalintos(gab, ast.vresult, ""));
+  }
 
   union gab_value_pair res = gab_compile(gab, (struct gab_compile_argt){
                                                   .ast = ast.vresult,
@@ -10707,9 +11709,10 @@ GAB_API union gab_value_pair gab_build(struct gab_triple gab,
   gab_assert(res.vresult != gab_cundefined, "Shall have vresult in all cases");
 
   if (res.status == gab_cinvalid)
-    return gab_gcunlock(gab), res;
+    return __gab_srcrelease(src), gab_gcunlock(gab), res;
 
   __gab_srccomplete(gab, src);
+  __gab_srcrelease(src);
 
   gab_value main = gab_block(gab, res.vresult);
   gab_assert(main != gab_cundefined, "Shall have vresult in all cases");
@@ -10744,6 +11747,32 @@ GAB_INTERNAL void __gab_gcepochinc(struct gab_triple gab) {
   gab.eg->jobs[gab.wkid].epoch++;
 }
 
+GAB_INTERNAL void __gab_gcstatmax(_Atomic uint64_t *stat, uint64_t v) {
+  uint64_t prev = atomic_load_explicit(stat, memory_order_relaxed);
+  while (v > prev && !atomic_compare_exchange_weak_explicit(
+                         stat, &prev, v, memory_order_relaxed,
+                         memory_order_relaxed))
+    ;
+}
+
+/*
+ * Record a duration in a total, a maximum, and a histogram.
+ * @see GAB_GCSTATS_NBUCKETS
+ */
+GAB_INTERNAL void __gab_gcstattime(_Atomic uint64_t *total,
+                                   _Atomic uint64_t *max,
+                                   _Atomic uint64_t *hist, uint64_t ns) {
+  atomic_fetch_add_explicit(total, ns, memory_order_relaxed);
+  __gab_gcstatmax(max, ns);
+
+  uint64_t us = ns / 1000;
+  uint64_t bucket = us ? 63 - clzl(us) : 0;
+  if (bucket >= GAB_GCSTATS_NBUCKETS)
+    bucket = GAB_GCSTATS_NBUCKETS - 1;
+
+  atomic_fetch_add_explicit(&hist[bucket], 1, memory_order_relaxed);
+}
+
 GAB_INTERNAL struct gab_obj **__gab_gcbufdata(struct gab_triple gab, uint8_t b,
                                               uint8_t wkid, uint8_t epoch) {
   gab_assert(epoch < GAB_GCNEPOCHS, "epoch shall not exceed maximum");
@@ -10770,6 +11799,14 @@ GAB_INTERNAL bool __gab_gcisdone(struct gab_triple gab) {
           return false;
       }
     }
+
+    for (int k = 0; k < GAB_GCNEPOCHS; k++)
+      if (gab.eg->jobs[i].young[k].len != 0)
+        return false;
+
+    for (int k = 0; k < cGAB_GC_RC_CACHE_LEN; k++)
+      if (gab.eg->jobs[i].rc[k].obj != nullptr)
+        return false;
   }
 
   return true;
@@ -10796,13 +11833,17 @@ GAB_INTERNAL void __gab_gcbufclear(struct gab_triple gab, uint8_t b,
   gab_assert(b < kGAB_NBUF, "buffer shall not exceed maximum");
   gab_assert(wkid < gab.eg->len, "wkid shall not exceed maximum");
 
-  gab.eg->jobs[wkid].buffers[b][epoch].len = 0;
+  struct gab_job *job = gab.eg->jobs + wkid;
+  __gab_gcstatmax(&job->hwm[b], job->buffers[b][epoch].len);
+  job->buffers[b][epoch].len = 0;
 }
 
 GAB_INTERNAL void __gab_gcobjinc(struct gab_gc *gc, struct gab_obj *obj) {
-  if (__gab_unlikely(obj->references == UINT8_MAX)) {
-    // The default value returned when the object doesn't exist is UINT8_MAX
-    // So we can always use and increment the rc value here.
+  uint16_t references = GAB_OBJ_RC(obj);
+
+  if (__gab_unlikely(references == GAB_OBJ_RC_MAX)) {
+    // The default value returned when the object doesn't exist is
+    // GAB_OBJ_RC_MAX. So we can always use and increment the rc value here.
     uint64_t rc = d_gab_obj_read(&gc->overflow_rc, obj);
 
     d_gab_obj_insert(&gc->overflow_rc, obj, rc + 1);
@@ -10810,16 +11851,18 @@ GAB_INTERNAL void __gab_gcobjinc(struct gab_gc *gc, struct gab_obj *obj) {
     return;
   }
 
-  obj->references++;
+  GAB_OBJ_SETRC(obj, references + 1);
 }
 
 GAB_INTERNAL void __gab_gcobjdec(struct gab_gc *gc, struct gab_obj *obj) {
-  if (__gab_unlikely(obj->references == UINT8_MAX)) {
+  uint16_t references = GAB_OBJ_RC(obj);
+
+  if (__gab_unlikely(references == GAB_OBJ_RC_MAX)) {
     uint64_t rc = d_gab_obj_read(&gc->overflow_rc, obj);
 
-    if (__gab_unlikely(rc == UINT8_MAX)) {
+    if (__gab_unlikely(rc == GAB_OBJ_RC_MAX)) {
       d_gab_obj_remove(&gc->overflow_rc, obj);
-      obj->references--;
+      GAB_OBJ_SETRC(obj, references - 1);
       return;
     }
 
@@ -10827,28 +11870,109 @@ GAB_INTERNAL void __gab_gcobjdec(struct gab_gc *gc, struct gab_obj *obj) {
     return;
   }
 
-  gab_assert(obj->references != 0,
+  gab_assert(references != 0,
              "Shall not underflow reference count of object with kind %d.",
              obj->kind);
 
-  obj->references--;
+  GAB_OBJ_SETRC(obj, references - 1);
   return;
 }
 
+/*
+ * Pending rc events are coalesced in a small, direct-mapped cache on each job
+ * before they reach the fixed-size inc/dec buffers.
+ *
+ * The collector only ever observes the *sum* of a job's rc events for an
+ * epoch, so an increment and a decrement of the same object within one epoch
+ * can cancel out. The exception is the creation reference of new objects -
+ * the first increment of a new object is what increments its children. This
+ * is why creation references are kept out of the cache, in the young lists.
+ *
+ * Each slot holds a delta of exactly +1 or -1. The inc/dec buffers keep
+ * cGAB_GC_RC_CACHE_LEN entries in reserve, so that the whole cache can be
+ * flushed at an epoch boundary without waiting on a collection.
+ */
+GAB_INTERNAL struct gab_gcrc *__gab_gcrcslot(struct gab_triple gab,
+                                             struct gab_obj *obj) {
+  uintptr_t h = (uintptr_t)obj >> 4;
+  h ^= h >> 9;
+  return gab.eg->jobs[gab.wkid].rc + (h & (cGAB_GC_RC_CACHE_LEN - 1));
+}
+
+GAB_INTERNAL bool __gab_gcrcemit(struct gab_triple gab, struct gab_gcrc *slot) {
+  int32_t e = __gab_gcepoch(gab);
+  uint8_t b = slot->delta > 0 ? kGAB_BUF_INC : kGAB_BUF_DEC;
+
+  if (__gab_gcbuflen(gab, b, gab.wkid, e) >=
+      GAB_GC_MOD_BUFF_MAX - cGAB_GC_RC_CACHE_LEN)
+    return false;
+
+  __gab_gcbufpush(gab, b, gab.wkid, e, slot->obj);
+
 #if cGAB_LOG_GC
-#define __gab_gcqdec(gab, obj) (___gab_gcqdec(gab, obj, __FUNCTION__, __LINE__))
+  fprintf(stderr, "(%i) %s\t%i\t%p\t%d\n", gab.wkid,
+          slot->delta > 0 ? "QINC" : "QDEC", e, slot->obj,
+          GAB_OBJ_RC(slot->obj));
+#endif
 
-GAB_INTERNAL void ___gab_gcqdec(struct gab_triple gab, struct gab_obj *obj,
-                                const char *func, int line) {
-#else
-GAB_INTERNAL void __gab_gcqdec(struct gab_triple gab, struct gab_obj *obj) {
+  slot->obj = nullptr;
+  slot->delta = 0;
+  return true;
+}
+
+/*
+ * Flush every pending rc event into the buffers of the current epoch.
+ *
+ * This is called at the end of each epoch, and when a job stops being alive.
+ */
+GAB_INTERNAL void __gab_gcrcflush(struct gab_triple gab) {
+  struct gab_job *wk = gab.eg->jobs + gab.wkid;
+
+  for (uint64_t i = 0; i < cGAB_GC_RC_CACHE_LEN; i++) {
+    struct gab_gcrc *slot = wk->rc + i;
+
+    if (!slot->obj)
+      continue;
+
+    int32_t e = __gab_gcepoch(gab);
+    uint8_t b = slot->delta > 0 ? kGAB_BUF_INC : kGAB_BUF_DEC;
+
+    // The reserve guarantees there is room here.
+    __gab_gcbufpush(gab, b, gab.wkid, e, slot->obj);
+
+    slot->obj = nullptr;
+    slot->delta = 0;
+  }
+}
+
+GAB_INTERNAL void __gab_gcqrc(struct gab_triple gab, struct gab_obj *obj,
+                              int32_t delta) {
+  struct gab_gcrc *slot = __gab_gcrcslot(gab, obj);
+
+  for (;;) {
+    if (!slot->obj) {
+      slot->obj = obj;
+      slot->delta = delta;
+      return;
+    }
+
+    // The opposite event is pending on the same object - they cancel out.
+    if (slot->obj == obj && slot->delta != delta) {
+#if cGAB_LOG_GC
+      fprintf(stderr, "(%i) QCANCEL\t%i\t%p\t%d\n", gab.wkid,
+              __gab_gcepoch(gab), obj, GAB_OBJ_RC(obj));
 #endif
-  int32_t e = __gab_gcepoch(gab);
+      slot->obj = nullptr;
+      slot->delta = 0;
+      return;
+    }
+
+    // The slot holds another event. Move it into the buffers to make room.
+    if (__gab_gcrcemit(gab, slot))
+      continue;
 
-  while (__gab_gcbuflen(gab, kGAB_BUF_DEC, gab.wkid, e) >=
-         GAB_GC_MOD_BUFF_MAX) {
-    // Try to signal a collection
-    gab_asigcoll(gab);
+    // Try to signal a collection. Ending the epoch flushes the slot.
+    __gab_gcsignal(gab, kGAB_GCTRIGGER_BUFFER);
 
     switch (gab_yield(gab)) {
     case sGAB_COLL:
@@ -10856,61 +11980,57 @@ GAB_INTERNAL void __gab_gcqdec(struct gab_triple gab, struct gab_obj *obj) {
       gab_sigpropagate(gab);
       break;
     case sGAB_TERM:
-      // In the case where a decrement is missed to this value
+      // In the case where an event is missed to this value
       // because we must handle the terminate signal:
       // Simply store this value in the engine's scratch buffer.
       // It will be decremented as the engine is cleaned up.
+      //
+      // A missed increment is performed immediately. This is safe as it
+      // can't result in destroying the object.
+      if (delta > 0)
+        __gab_gcobjinc(&gab.eg->gc, obj);
+
       gab_egkeep(gab.eg, __gab_obj(obj));
       return;
     default:
       break;
     }
-
-    e = __gab_gcepoch(gab);
   }
-
-  __gab_gcbufpush(gab, kGAB_BUF_DEC, gab.wkid, e, obj);
-
-#if cGAB_LOG_GC
-  fprintf(stderr, "(%i) QDEC\t%i\t%p\t%i\t%s:%i\n", gab.wkid,
-          __gab_gcepoch(gab), obj, obj->references, func, line);
-#endif
 }
 
-GAB_INTERNAL void __gab_gcqinc(struct gab_triple gab, struct gab_obj *obj) {
-  int32_t e = __gab_gcepoch(gab);
-
-  while (__gab_gcbuflen(gab, kGAB_BUF_INC, gab.wkid, e) >=
-         GAB_GC_MOD_BUFF_MAX) {
-    // Try to signal a collection
-    gab_asigcoll(gab);
+/*
+ * Queue the creation reference of a new object to be dropped.
+ *
+ * Most objects are temporaries which are never incremented - they are born
+ * and die within an epoch. These never touch the fixed-size buffers. Instead,
+ * once a job has created cGAB_GC_YOUNG_MAX objects in an epoch, it signals a
+ * collection - just as a full buffer does.
+ */
+GAB_INTERNAL void __gab_gcqyoung(struct gab_triple gab, struct gab_obj *obj) {
+  while (gab.eg->jobs[gab.wkid].young[__gab_gcepoch(gab)].len >=
+         cGAB_GC_YOUNG_MAX) {
+    __gab_gcsignal(gab, kGAB_GCTRIGGER_BUFFER);
 
     switch (gab_yield(gab)) {
     case sGAB_COLL:
       gab_gcepochnext(gab);
       gab_sigpropagate(gab);
-      break;
+      continue;
     case sGAB_TERM:
-      // In the case where an increment is missed to this value
-      // because we must handle the terminate signal:
-      // Immediately perform an increment. This is safe as it can't result
-      // in destroying the object.
-      // Give the object to the scratch buffer for resolving later.
-      __gab_gcobjinc(&gab.eg->gc, obj);
-      gab_egkeep(gab.eg, __gab_obj(obj));
-      return;
-    default:
+      // The young list can grow - it is drained as the engine is cleaned up.
       break;
+    default:
+      continue;
     }
 
-    e = __gab_gcepoch(gab);
+    break;
   }
 
-  __gab_gcbufpush(gab, kGAB_BUF_INC, gab.wkid, e, obj);
+  v_gab_obj_push(&gab.eg->jobs[gab.wkid].young[__gab_gcepoch(gab)], obj);
 
 #if cGAB_LOG_GC
-  fprintf(stderr, "(%i) QINC\t%i\t%p\t%d\n", gab.wkid, __gab_gcepoch(gab), obj,
-          obj->references);
+  fprintf(stderr, "(%i) QYOUNG\t%i\t%p\t%d\n", gab.wkid, __gab_gcepoch(gab),
+          obj, GAB_OBJ_RC(obj));
 #endif
 }
 
@@ -10922,11 +12042,11 @@ GAB_INTERNAL void __gab_gcqdestroy(struct gab_triple gab, struct gab_obj *obj) {
 
   v_gab_obj_push(&gab.eg->gc.dead[__gab_gcepoch(gab)], obj);
 
-  gab_assert(obj->references == 0, "Shall only qdestroy objects with 0 refs");
+  gab_assert(GAB_OBJ_RC(obj) == 0, "Shall only qdestroy objects with 0 refs");
 
 #if cGAB_LOG_GC
   fprintf(stderr, "(%i) QDEAD\t%i\t%p\t%d\n", gab.wkid, __gab_gcepoch(gab), obj,
-          obj->references);
+          GAB_OBJ_RC(obj));
 #endif
 }
 
@@ -10974,7 +12094,7 @@ GAB_INTERNAL void __gab_gcobjeachdo(struct gab_obj *obj,
                                     struct gab_triple gab) {
 #if cGAB_LOG_GC
   fprintf(stderr, "RECURSE\t%i\t%p\t%i\n", __gab_gcepoch(gab), obj,
-          obj->references);
+          GAB_OBJ_RC(obj));
 #endif
   switch (obj->kind) {
   default:
@@ -11087,19 +12207,19 @@ GAB_INTERNAL void __gab_gcdestroy(struct gab_triple gab, struct gab_obj *obj) {
 #endif
 
   // TODO @cgab @doc: Test/Fix resurrection
-  if (obj->references > 0)
+  if (GAB_OBJ_RC(obj) > 0)
     return; // resurrected
 
-  gab_assert(obj->references == 0,
+  gab_assert(GAB_OBJ_RC(obj) == 0,
              "Shall only destroy objects with 0 references, not %i on kind %d",
-             obj->references, obj->kind);
+             GAB_OBJ_RC(obj), obj->kind);
 
 #if cGAB_LOG_GC
   gab_assert(!GAB_OBJ_IS_FREED(obj), "(%i) DFREE\t%p\t%s:%i\n", gab.wkid, obj,
              func, line);
 
   fprintf(stderr, "(%i) FREE\t%i\t%p\t%i\t%s:%d\n", gab.wkid,
-          __gab_gcepoch(gab), obj, obj->references, func, line);
+          __gab_gcepoch(gab), obj, GAB_OBJ_RC(obj), func, line);
   __gab_objdestroy(gab, obj);
   GAB_OBJ_FREED(obj);
 #else
@@ -11112,12 +12232,12 @@ GAB_INTERNAL void __gab_gcobjdecref(struct gab_triple gab,
                                     struct gab_obj *obj) {
 #if cGAB_LOG_GC
   fprintf(stderr, "(%i) DEC\t%i\t%p\t%d\n", gab.wkid, __gab_gcepoch(gab), obj,
-          obj->references - 1);
+          GAB_OBJ_RC(obj) - 1);
 #endif
 
   __gab_gcobjdec(&gab.eg->gc, obj);
 
-  if (obj->references == 0) {
+  if (GAB_OBJ_RC(obj) == 0) {
     if (!GAB_OBJ_IS_NEW(obj))
       __gab_gcobjeachdo(obj, __gab_gcobjdecref, gab);
 
@@ -11129,7 +12249,7 @@ GAB_INTERNAL void __gab_gcobjincref(struct gab_triple gab,
                                     struct gab_obj *obj) {
 #if cGAB_LOG_GC
   fprintf(stderr, "INC\t%i\t%p\t%d\n", __gab_gcepoch(gab), obj,
-          obj->references + 1);
+          GAB_OBJ_RC(obj) + 1);
 #endif
 
   __gab_gcobjinc(&gab.eg->gc, obj);
@@ -11196,10 +12316,10 @@ GAB_API gab_value gab_iref(struct gab_triple gab, gab_value value) {
 
 #if cGAB_LOG_GC
   fprintf(stderr, "(%i) IREF\t%i\t%p\t%d\t%s:%i\n", gab.wkid,
-          __gab_gcepoch(gab), obj, obj->references, func, line);
+          __gab_gcepoch(gab), obj, GAB_OBJ_RC(obj), func, line);
 #endif
 
-  __gab_gcqinc(gab, obj);
+  __gab_gcqrc(gab, obj, 1);
 
 #if cGAB_DEBUG_GC
   gab_sigcoll(gab);
@@ -11229,18 +12349,14 @@ GAB_API gab_value gab_dref(struct gab_triple gab, gab_value value) {
 #if cGAB_LOG_GC
   if (GAB_OBJ_IS_NEW(obj)) {
     fprintf(stderr, "(%i) NEWDREF\t%i\t%p\t%d\t%s:%i\n", gab.wkid,
-            __gab_gcepoch(gab), obj, obj->references, func, line);
+            __gab_gcepoch(gab), obj, GAB_OBJ_RC(obj), func, line);
   } else {
     fprintf(stderr, "(%i) DREF\t%i\t%p\t%d\t%s:%i\n", gab.wkid,
-            __gab_gcepoch(gab), obj, obj->references, func, line);
+            __gab_gcepoch(gab), obj, GAB_OBJ_RC(obj), func, line);
   }
 #endif
 
-#if cGAB_LOG_GC
-  ___gab_gcqdec(gab, obj, func, line);
-#else
-  __gab_gcqdec(gab, obj);
-#endif
+  __gab_gcqrc(gab, obj, -1);
 
   return value;
 }
@@ -11265,6 +12381,12 @@ GAB_API void gab_gcdestroy(struct gab_triple gab) {
   for (int e = 0; e < GAB_GCNEPOCHS; e++) {
     v_gab_obj_destroy(&gab.eg->gc.dead[e]);
   }
+
+  for (int i = 0; i < gab.eg->len; i++) {
+    for (int e = 0; e < GAB_GCNEPOCHS; e++) {
+      v_gab_obj_destroy(&gab.eg->jobs[i].young[e]);
+    }
+  }
   __gab_jbunalive(gab, 0);
 }
 
@@ -11291,10 +12413,13 @@ GAB_API void gab_gcunlock(struct gab_triple gab) {
   wk->locked -= 1;
 
   if (!wk->locked) {
-    for (uint64_t i = 0; i < wk->nlocked; i++)
-      GAB_OBJ_NOT_BUFFERED(gab_valtoo(wk->lockbuf[i]));
-
-    gab_ndref(gab, 1, wk->nlocked, wk->lockbuf);
+    // These are creation references - they may not be coalesced with other
+    // rc events, so they are queued as young objects.
+    for (uint64_t i = 0; i < wk->nlocked; i++) {
+      struct gab_obj *obj = gab_valtoo(wk->lockbuf[i]);
+      GAB_OBJ_NOT_BUFFERED(obj);
+      __gab_gcqyoung(gab, obj);
+    }
 
     wk->nlocked = 0;
   }
@@ -11330,6 +12455,15 @@ GAB_INTERNAL void __gab_gcdodecrements(struct gab_triple gab, int32_t epoch) {
     // Reset the length of the dec buffer for this worker
     __gab_gcbufclear(gab, kGAB_BUF_STK, wkid, epoch);
     __gab_gcbufclear(gab, kGAB_BUF_DEC, wkid, epoch);
+
+    // Drop the creation reference of this worker's young objects.
+    // Those which were never incremented are destroyed here.
+    v_gab_obj *young = &gab.eg->jobs[wkid].young[epoch];
+    for (uint64_t i = 0; i < young->len; i++)
+      __gab_gcobjdecref(gab, young->data[i]);
+
+    __gab_gcstatmax(&gab.eg->jobs[wkid].young_hwm, young->len);
+    young->len = 0;
   }
 
 #if cGAB_LOG_GC
@@ -11344,6 +12478,9 @@ GAB_INTERNAL void __gab_gcdoepoch(struct gab_triple gab, int32_t e) {
   fprintf(stderr, "(%i) PEPOCH\t%i\n", gab.wkid, e);
 #endif
 
+  // Any rc events still pending in the cache belong to this epoch.
+  __gab_gcrcflush(gab);
+
   if (q_gab_value_is_empty(&wk->working_queue))
     goto fin;
 
@@ -11422,13 +12559,22 @@ GAB_API void __gab_gcepochnext(struct gab_triple gab, const char *func,
 #else
 GAB_API void gab_gcepochnext(struct gab_triple gab) {
 #endif
-  if (gab.wkid > 0)
+  if (gab.wkid > 0) {
+    uint64_t start = __gab_nowns();
+
     __gab_gcdoepoch(gab, __gab_gcepoch(gab));
+
+    struct gab_gctelemetry *stats = &gab.eg->gc.stats;
+    __gab_gcstattime(&stats->pause_ns, &stats->pause_max_ns, stats->pause_hist,
+                     __gab_nowns() - start);
+  }
 }
 
 GAB_API void gab_gcdocollect(struct gab_triple gab) {
   gab_assert(gab.wkid == 0, "Shall only be run on gc thread");
 
+  uint64_t start = __gab_nowns();
+
   int32_t epoch = __gab_gcepoch(gab);
   int32_t last = __gab_gcepochlast(gab);
 
@@ -11468,6 +12614,19 @@ GAB_API void gab_gcdocollect(struct gab_triple gab) {
 
   __gab_gcdeadreap(gab);
 
+  struct gab_gctelemetry *stats = &gab.eg->gc.stats;
+
+  uint64_t ndead = 0;
+  for (int i = 0; i < GAB_GCNEPOCHS; i++)
+    ndead += gab.eg->gc.dead[i].len;
+
+  atomic_store_explicit(&stats->dead, ndead, memory_order_relaxed);
+  atomic_store_explicit(&stats->overflow_rc, gab.eg->gc.overflow_rc.len,
+                        memory_order_relaxed);
+  atomic_fetch_add_explicit(&stats->collections, 1, memory_order_relaxed);
+  __gab_gcstattime(&stats->collect_ns, &stats->collect_max_ns,
+                   stats->collect_hist, __gab_nowns() - start);
+
 #if cGAB_LOG_GC
   fprintf(stderr, "CEPOCH! %i\n", epoch);
 #endif
@@ -11652,7 +12811,15 @@ static handler handlers[] = {
 #define LOG(gab, op)
 #endif
 
+#if cGAB_LOG_VM_SEQUENCES
+#define LOG_SEQUENCE(gab, op) __gab_vmseq(gab, op)
+#else
+#define LOG_SEQUENCE(gab, op)
+#endif
+
 #define CHECK_SIGNAL()                                                         \
+  if (__gab_unlikely(GAB().flags & fGAB_PROFILE))                              \
+    __gab_vmprofile(GAB(), VM(), FB(), IP());                                  \
   if (gab_sigwaiting(GAB()))                                                   \
     switch (gab_yield(GAB())) {                                                \
     case sGAB_COLL:                                                            \
@@ -11672,6 +12839,7 @@ static handler handlers[] = {
     uint8_t o = (op);                                                          \
                                                                                \
     LOG(GAB(), o);                                                             \
+    LOG_SEQUENCE(GAB(), o);                                                    \
                                                                                \
     gab_assert(SP() < VM()->sb + cGAB_STACK_MAX, "Shall have stackspace");     \
                                                                                \
@@ -11976,6 +13144,246 @@ GAB_API gab_value gab_fibstacktrace(struct gab_triple gab, gab_value fiber) {
   return __gab_sprintstk(gab, vm, f, ip, GAB_TERM, nullptr, empty);
 }
 
+GAB_INTERNAL void __gab_vmprofpush(v_char *buf, struct gab_oblock *b,
+                                   uint64_t tok) {
+  struct gab_oprototype *p = GAB_VAL_TO_PROTOTYPE(b->p);
+  struct gab_src *src = p->src;
+
+  if (buf->len)
+    v_char_push(buf, ';');
+
+  const char *name = gab_strdata(&src->name);
+  v_char_spush(buf, (s_char){.data = name, .len = strlen(name)});
+
+  char line[24];
+  int len = snprintf(line, sizeof(line), ":%" PRIu64 ":", gab_tsrcline(src, tok));
+  v_char_spush(buf, (s_char){.data = line, .len = len});
+
+  // Sources loaded from bytecode have no tokens to show.
+  if (tok >= src->token_srcs.len)
+    return;
+
+  // The collapsed format separates frames with ';' and the weight with ' '.
+  s_char tok_src = v_s_char_val_at(&src->token_srcs, tok);
+  for (uint64_t i = 0; i < tok_src.len; i++) {
+    char c = tok_src.data[i];
+    v_char_push(buf, c == ';' || c == ' ' || c == '\n' ? '_' : c);
+  }
+}
+
+/*
+ * Called at each signal check while profiling.
+ *
+ * Rather than interrupting the job with a timer, the job samples itself: every
+ * cGAB_PROFILE_CHECKS checks it reads the clock, and once
+ * cGAB_PROFILE_INTERVAL_NS has passed the current stack is charged with all
+ * of the time since the last sample.
+ */
+GAB_INTERNAL void __gab_vmprofile(struct gab_triple gab, struct gab_vm *vm,
+                                  gab_value *f, uint8_t *ip) {
+  struct gab_job *job = gab.eg->jobs + gab.wkid;
+
+  if (++job->prof_ticks < cGAB_PROFILE_CHECKS)
+    return;
+
+  job->prof_ticks = 0;
+
+  uint64_t now = __gab_nowns();
+  uint64_t elapsed = now - job->prof_last;
+
+  if (elapsed < cGAB_PROFILE_INTERVAL_NS)
+    return;
+
+  job->prof_last = now;
+
+  struct gab_profframe {
+    struct gab_oblock *b;
+    uint64_t tok;
+  } frames[cGAB_PROFILE_MAX_DEPTH];
+
+  int nframes = 0;
+  struct gab_oblock *b = __gab_vmframeblk(f);
+
+  if (b)
+    frames[nframes++] = (struct gab_profframe){b, __gab_tokenfromip(gab, b, ip)};
+
+  ip = __gab_vmframeip(f);
+  f = __gab_vmframeparent(f);
+
+  while (f && __gab_vmframeparent(f) > vm->sb &&
+         nframes < cGAB_PROFILE_MAX_DEPTH) {
+    b = __gab_vmframeblk(f);
+
+    if (b)
+      frames[nframes++] =
+          (struct gab_profframe){b, __gab_tokenfromip(gab, b, ip)};
+
+    ip = __gab_vmframeip(f);
+    f = __gab_vmframeparent(f);
+  }
+
+  if (!nframes)
+    return;
+
+  uint64_t keys[cGAB_PROFILE_MAX_DEPTH * 2];
+  for (int i = 0; i < nframes; i++) {
+    keys[i * 2] = (uintptr_t)GAB_VAL_TO_PROTOTYPE(frames[i].b->p)->src;
+    keys[i * 2 + 1] = frames[i].tok;
+  }
+
+  uint64_t nkeys = nframes * 2;
+  uint64_t hash = __gab_chshwords(gab.eg->hash_seed, nkeys, keys);
+  uint64_t idx;
+
+  // Two different stacks may share a hash - step past any that don't match.
+  while ((idx = d_uint64_t_read(&job->prof_index, hash))) {
+    a_uint64_t *seen = v_a_uint64_t_val_at(&job->prof_frames, idx - 1);
+
+    if (seen->len == nkeys &&
+        !memcmp(seen->data, keys, nkeys * sizeof(uint64_t)))
+      break;
+
+    hash++;
+  }
+
+  if (!idx) {
+    v_char buf = {0};
+
+    // Collapsed stacks are written root first.
+    for (int i = nframes - 1; i >= 0; i--)
+      __gab_vmprofpush(&buf, frames[i].b, frames[i].tok);
+
+    v_a_char_push(&job->prof_stacks, a_char_create(buf.data, buf.len));
+    v_a_uint64_t_push(&job->prof_frames, a_uint64_t_create(keys, nkeys));
+    v_uint64_t_push(&job->prof_weights, 0);
+    v_char_destroy(&buf);
+
+    idx = job->prof_stacks.len;
+    d_uint64_t_insert(&job->prof_index, hash, idx);
+  }
+
+  job->prof_weights.data[idx - 1] += elapsed / 1000;
+}
+
+GAB_INTERNAL void __gab_profdump(struct gab_triple gab) {
+  for (uint64_t i = 0; i < gab.eg->len; i++) {
+    struct gab_job *job = gab.eg->jobs + i;
+
+    for (uint64_t j = 0; j < job->prof_stacks.len; j++) {
+      a_char *stack = v_a_char_val_at(&job->prof_stacks, j);
+      uint64_t weight = v_uint64_t_val_at(&job->prof_weights, j);
+
+      if (gab.eg->profile && weight)
+        fprintf(gab.eg->profile, "%.*s %" PRIu64 "\n", (int)stack->len,
+                stack->data, weight);
+
+      a_char_destroy(stack);
+      a_uint64_t_destroy(v_a_uint64_t_val_at(&job->prof_frames, j));
+    }
+
+    v_a_char_destroy(&job->prof_stacks);
+    v_a_uint64_t_destroy(&job->prof_frames);
+    v_uint64_t_destroy(&job->prof_weights);
+    d_uint64_t_destroy(&job->prof_index);
+  }
+
+  if (gab.eg->profile)
+    fflush(gab.eg->profile);
+}
+
+#if cGAB_LOG_VM_SEQUENCES
+/*
+ * Opcode sequences are keyed by their opcodes, one per byte. Pairs are tagged
+ * with a high bit so that they don't collide with triples.
+ */
+#define GAB_VMSEQ_PAIR ((uint64_t)1 << 24)
+
+GAB_INTERNAL void __gab_vmseqcount(d_uint64_t *counts, uint64_t key,
+                                   uint64_t n) {
+  d_uint64_t_insert(counts, key, d_uint64_t_read(counts, key) + n);
+}
+
+/*
+ * Count the pair and triple of opcodes ending in op.
+ */
+GAB_INTERNAL void __gab_vmseq(struct gab_triple gab, uint8_t op) {
+  struct gab_job *job = gab.eg->jobs + gab.wkid;
+
+  if (job->seq_n > 0)
+    __gab_vmseqcount(&job->seq_counts,
+                     GAB_VMSEQ_PAIR | (uint64_t)job->seq_ops[1] << 8 | op, 1);
+
+  if (job->seq_n > 1)
+    __gab_vmseqcount(&job->seq_counts,
+                     (uint64_t)job->seq_ops[0] << 16 |
+                         (uint64_t)job->seq_ops[1] << 8 | op,
+                     1);
+
+  job->seq_ops[0] = job->seq_ops[1];
+  job->seq_ops[1] = op;
+  job->seq_n++;
+}
+
+struct gab_vmseq {
+  uint64_t key, count;
+};
+
+GAB_INTERNAL int __gab_vmseqcmp(const void *a, const void *b) {
+  const struct gab_vmseq *sa = a, *sb = b;
+  return (sa->count < sb->count) - (sa->count > sb->count);
+}
+
+#endif
+
+/*
+ * Merge the sequences counted by each job, and write them to stderr - most
+ * frequent first. Each line is a count followed by the opcodes, ie:
+ *
+ *  1024 LOAD_LOCAL SEND
+ *  512 TUPLE LOAD_LOCAL SEND
+ */
+GAB_INTERNAL void __gab_vmseqdump(struct gab_triple gab) {
+#if cGAB_LOG_VM_SEQUENCES
+  d_uint64_t merged = {0};
+
+  for (uint64_t i = 0; i < gab.eg->len; i++) {
+    d_uint64_t *counts = &gab.eg->jobs[i].seq_counts;
+
+    for (uint64_t j = 0; j < counts->cap; j++)
+      if (d_uint64_t_iexists(counts, j))
+        __gab_vmseqcount(&merged, d_uint64_t_ikey(counts, j),
+                         d_uint64_t_ival(counts, j));
+
+    d_uint64_t_destroy(counts);
+  }
+
+  struct gab_vmseq *seqs = malloc(sizeof(struct gab_vmseq) * (merged.len + 1));
+  uint64_t nseqs = 0;
+
+  for (uint64_t j = 0; j < merged.cap; j++)
+    if (d_uint64_t_iexists(&merged, j))
+      seqs[nseqs++] = (struct gab_vmseq){d_uint64_t_ikey(&merged, j),
+                                         d_uint64_t_ival(&merged, j)};
+
+  qsort(seqs, nseqs, sizeof(struct gab_vmseq), __gab_vmseqcmp);
+
+  for (uint64_t i = 0; i < nseqs; i++) {
+    uint64_t k = seqs[i].key;
+
+    fprintf(stderr, "%" PRIu64, seqs[i].count);
+
+    if (!(k & GAB_VMSEQ_PAIR))
+      fprintf(stderr, " %s", gab_opcode_names[(k >> 16) & 0xff]);
+
+    fprintf(stderr, " %s %s\n", gab_opcode_names[(k >> 8) & 0xff],
+            gab_opcode_names[k & 0xff]);
+  }
+
+  free(seqs);
+  d_uint64_t_destroy(&merged);
+#endif
+}
+
 GAB_INTERNAL union gab_value_pair __gab_vvmterm(struct gab_triple gab,
                                                 const char *fmt, va_list va) {
   gab_value fiber = gab_thisfiber(gab);
@@ -12503,6 +13911,10 @@ GAB_INTERNAL union gab_value_pair __gab_vmexec(struct gab_triple gab,
 
   gab.flags |= fiber->flags;
 
+  // Time spent waiting for work isn't charged to the next sample.
+  if (gab.flags & fGAB_PROFILE)
+    gab.eg->jobs[gab.wkid].prof_last = __gab_nowns();
+
   gab_assert(fiber->vm.sb[2] == 0, "Shall not have return frame");
   gab_assert(fiber->vm.kb, "Shall have constant table");
   gab_assert(fiber->vm.ip, "Shall have ip");
@@ -12567,6 +13979,100 @@ GAB_INTERNAL bool __gab_vmtrysetuplocalmatch(struct gab_triple gab, gab_value m,
   return true;
 }
 
+/*
+ * A local match on exactly true: and false: is how gab branches, ie:
+ *
+ *  do_fib: .defcase {
+ *    true:  n :: n
+ *    false: n :: (n - 1).fib + (n - 2).fib
+ *  }
+ *
+ * Both cache lines are known ahead of time, so these sends can pick their
+ * line by comparing the receiver - instead of finding its type and hashing it.
+ *
+ * A default case may sit in a third line. No boolean reaches it, and any other
+ * receiver misses the guard and finds it through the full lookup.
+ */
+GAB_INTERNAL bool __gab_vmmatchisbool(gab_value *ks) {
+  const uint64_t t = MATCH_HASHT(gab_true), f = MATCH_HASHT(gab_false);
+
+  if (t == f)
+    return false;
+
+  if (ks[GAB_SEND_KTYPE + t] != gab_true || ks[GAB_SEND_KTYPE + f] != gab_false)
+    return false;
+
+  for (uint64_t i = 0; i < cGAB_SEND_CACHE_LEN; i++) {
+    uint64_t idx = i * GAB_SEND_CACHE_SIZE;
+
+    if (idx == t || idx == f || ks[GAB_SEND_KSPEC + idx] == gab_cinvalid)
+      continue;
+
+    if (ks[GAB_SEND_KTYPE + idx] != gab_cundefined)
+      return false;
+  }
+
+  return true;
+}
+
+enum gab_trivial_k {
+  kTRIVIAL_NONE,
+  kTRIVIAL_CONSTANT,
+  kTRIVIAL_ARGUMENT,
+};
+
+/*
+ * Some blocks are trivial - they evaluate to a single constant, or to one of
+ * their arguments. ie:
+ *
+ *  n :: n
+ *  () :: 'gab'
+ *
+ * These compile to exactly:
+ *
+ *  TRIM <nlocals>, TUPLE_CONSTANT <k> | TUPLE_LOAD_LOCAL <i>, RETURN
+ *
+ * The TRIM and RETURN may have already been rewritten to one of their
+ * specialized forms, which is fine - they are all the same width.
+ *
+ * A send which specializes to one of these blocks can produce the value
+ * in-place, without pushing a frame.
+ */
+GAB_INTERNAL enum gab_trivial_k
+__gab_vmtrivialblock(struct gab_triple gab, struct gab_oprototype *p,
+                     gab_value *out) {
+  uint8_t *ip = proto_ip(gab, p);
+
+  if (ip[0] < OP_TRIM || ip[0] > OP_TRIM_UP9)
+    return kTRIVIAL_NONE;
+
+  enum gab_trivial_k k;
+  gab_value v;
+
+  switch (ip[2]) {
+  case OP_TUPLE_CONSTANT:
+    k = kTRIVIAL_CONSTANT;
+    v = proto_ks(gab, p)[((uint16_t)ip[3] << 8) | ip[4]];
+    ip += 5;
+    break;
+  case OP_TUPLE_LOAD_LOCAL:
+    k = kTRIVIAL_ARGUMENT;
+    v = ip[3];
+    ip += 4;
+    break;
+  default:
+    return kTRIVIAL_NONE;
+  }
+
+  if (ip[0] != OP_RETURN && ip[0] != OP_RETURN_1)
+    return kTRIVIAL_NONE;
+
+  // Only now that the block is known to be trivial is it safe to replace
+  // the send's cached spec - a non-trivial block is still called through it.
+  *out = v;
+  return k;
+}
+
 /*
  * This file defines implementations for an extensive set of macros.
  *
@@ -13104,6 +14610,17 @@ extern void putcs(char *arg);
     [[clang::musttail]] return OP_TRIM_HANDLER(DISPATCH_ARGS());               \
   })
 
+/*
+ * Undo the fusion of a CONSTANT with the send after it, and run the
+ * instruction as a plain CONSTANT.
+ */
+#define MISS_CONSTANT_SEND(reason)                                             \
+  ({                                                                           \
+    IP() = at;                                                                 \
+    WRITE_BYTE(1, OP_CONSTANT);                                                \
+    [[clang::musttail]] return OP_CONSTANT_HANDLER(DISPATCH_ARGS());           \
+  })
+
 #define MISS_CACHED_RETURN(reason)                                             \
   ({ [[clang::musttail]] return OP_RETURN_HANDLER(DISPATCH_ARGS()); })
 
@@ -13220,6 +14737,10 @@ extern void putcs(char *arg);
     SEND_GUARD_TYPE(r, ks[GAB_SEND_KTYPE + idx]);                              \
   })
 
+#define CONSTANT_SEND_GUARD(clause)                                            \
+  if (__gab_unlikely(!(clause)))                                               \
+    MISS_CONSTANT_SEND("Constant send failed");
+
 #define TRIM_GUARD(clause, reason)                                             \
   if (__gab_unlikely(!(clause)))                                               \
     MISS_CACHED_TRIM(reason);
@@ -13559,7 +15080,7 @@ extern void putcs(char *arg);
 #define MICRO_OP_BINARY_LSH(a, b) BINARY_SHIFT(a, b, <<, >>)
 #define MICRO_OP_BINARY_RSH(a, b) BINARY_SHIFT(a, b, >>, <<)
 
-#define MICRO_OP_BINARY_EQ(a, b) (gab_valeq(a, b))
+#define MICRO_OP_BINARY_EQ(a, b) (__gab_valequal(a, b))
 
 #define MICRO_OP_BINARY_CONCAT(a, b)                                           \
   ({                                                                           \
@@ -13673,6 +15194,54 @@ extern void putcs(char *arg);
     NEXT();                                                                    \
   }
 
+/*
+ * A CONSTANT which feeds a numeric primitive send, ie: (n - 1) or (n < 2).
+ *
+ * The constant is never pushed - it is passed straight to the primitive. The
+ * SEND that follows is skipped over, though its constants are still used to
+ * check the message epoch. If the send was respecialized, or the receiver
+ * isn't a lone number, the CONSTANT is restored and run as normal.
+ *
+ * @see CASE_CODE(CONSTANT)
+ */
+#define IMPL_CONSTANT_SEND_BINARY(CODE, a_type, a_unboxer, b_type, b_unboxer,  \
+                                  c_type, c_boxer, primitive)                  \
+  CASE_CODE(CONSTANT_SEND_##CODE) {                                            \
+    uint8_t *at = IP();                                                        \
+                                                                               \
+    gab_value b = READ_CONSTANT;                                               \
+                                                                               \
+    CONSTANT_SEND_GUARD(*IP() == OP_SEND_##CODE);                              \
+                                                                               \
+    SKIP_BYTE;                                                                 \
+    gab_value *ks = READ_SENDCONSTANTS;                                        \
+    uint64_t have = HV();                                                      \
+    uint64_t below_have = BELOW_HV();                                          \
+                                                                               \
+    CONSTANT_SEND_GUARD(                                                       \
+        gab_valeq(atomic_load(&EG()->messages_epoch), ks[GAB_SEND_KSPECS]));   \
+    CONSTANT_SEND_GUARD(have == 1);                                            \
+                                                                               \
+    gab_value a = PEEK_N(have);                                                \
+                                                                               \
+    CONSTANT_SEND_GUARD(gab_valisn(a));                                        \
+                                                                               \
+    a_type val_a = a_unboxer(a);                                               \
+    b_type val_b = b_unboxer##2(b);                                            \
+                                                                               \
+    c_type val_c = primitive(val_a, val_b);                                    \
+                                                                               \
+    gab_value c = c_boxer(val_c);                                              \
+                                                                               \
+    DROP_N(have + FRAME_SIZE);                                                 \
+                                                                               \
+    PUSH(c);                                                                   \
+                                                                               \
+    SET_HV(below_have + 1);                                                    \
+                                                                               \
+    NEXT();                                                                    \
+  }
+
 #define IMPL_RETURN_N(n)                                                       \
   CASE_CODE(RETURN_##n) {                                                      \
     RETURN_GUARD_EXACTLY_N((uint64_t)n);                                       \
@@ -13750,6 +15319,43 @@ CASE_CODE(MATCHSEND_BLOCK) {
   NEXT();
 }
 
+/*
+ * @see __gab_vmmatchisbool
+ */
+CASE_CODE(MATCHTAILSEND_BOOL) {
+  gab_value *ks = READ_SENDCONSTANTS;
+  uint64_t have = HV();
+
+  SEND_GUARD_CACHED_MESSAGE_SPECS(ks[GAB_SEND_KSPECS]);
+
+  gab_value r = PEEK_N(have);
+
+  SEND_GUARD(r == gab_true || r == gab_false, "Not boolean");
+
+  uint8_t idx = r == gab_true ? MATCH_HASHT(gab_true) : MATCH_HASHT(gab_false);
+
+  MICRO_OP_MATCHTAILCALL_BLOCK(idx, have);
+
+  NEXT();
+}
+
+CASE_CODE(MATCHSEND_BOOL) {
+  gab_value *ks = READ_SENDCONSTANTS;
+  uint64_t have = HV();
+
+  SEND_GUARD_CACHED_MESSAGE_SPECS(ks[GAB_SEND_KSPECS]);
+
+  gab_value r = PEEK_N(have);
+
+  SEND_GUARD(r == gab_true || r == gab_false, "Not boolean");
+
+  uint8_t idx = r == gab_true ? MATCH_HASHT(gab_true) : MATCH_HASHT(gab_false);
+
+  MICRO_OP_MATCHCALL_BLOCK(idx, have);
+
+  NEXT();
+}
+
 CASE_CODE(LOAD_UPVALUE) {
   uint64_t have = HV();
 
@@ -14096,6 +15702,51 @@ IMPL_SEND_BINARY(PRIMITIVE_EQ, NOP, MICRO_OP_UNBOXV_T, MICRO_OP_UNBOXV,
                  MICRO_OP_UNBOXV_T, MICRO_OP_UNBOXV, MICRO_OP_UNBOXB_T,
                  MICRO_OP_BOXB, MICRO_OP_BINARY_EQ);
 
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_ADD, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_BOXN,
+                          MICRO_OP_BINARY_ADD);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_SUB, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_BOXN,
+                          MICRO_OP_BINARY_SUB);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_DIV, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_BOXN,
+                          MICRO_OP_BINARY_DIV);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_MUL, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_BOXN,
+                          MICRO_OP_BINARY_MUL);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_MOD, MICRO_OP_UNBOXI_T, MICRO_OP_UNBOXI,
+                          MICRO_OP_UNBOXI_T, MICRO_OP_UNBOXI,
+                          MICRO_OP_UNBOXI_T, MICRO_OP_BOXN,
+                          MICRO_OP_BINARY_MOD);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_LT, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXB_T, MICRO_OP_BOXB,
+                          MICRO_OP_BINARY_LT);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_LTE, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXB_T, MICRO_OP_BOXB,
+                          MICRO_OP_BINARY_LTE);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_GT, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXB_T, MICRO_OP_BOXB,
+                          MICRO_OP_BINARY_GT);
+
+IMPL_CONSTANT_SEND_BINARY(PRIMITIVE_GTE, MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXF_T, MICRO_OP_UNBOXF,
+                          MICRO_OP_UNBOXB_T, MICRO_OP_BOXB,
+                          MICRO_OP_BINARY_GTE);
+
 // !bool = bool
 IMPL_SEND_UNARY(PRIMITIVE_LIN, ISB, MICRO_OP_BOXB, MICRO_OP_UNBOXB_T,
                 MICRO_OP_UNBOXB, MICRO_OP_UNARY_LIN);
@@ -14285,6 +15936,34 @@ CASE_CODE(SEND_CONSTANT) {
   NEXT();
 }
 
+/*
+ * The specialization is a trivial block which evaluates to one of its
+ * arguments. Rather than call it, just take that argument.
+ *
+ * @see __gab_vmtrivialblock
+ */
+CASE_CODE(SEND_ARGUMENT) {
+  gab_value *ks = READ_SENDCONSTANTS;
+  uint64_t have = HV();
+  uint64_t below_have = BELOW_HV();
+
+  gab_value r = PEEK_N(have);
+
+  SEND_GUARD_CACHED_MESSAGE_SPECS(ks[GAB_SEND_KSPECS]);
+  SEND_GUARD_CACHED_RECEIVER_TYPE(r);
+
+  uint64_t i = ks[GAB_SEND_KSPEC];
+  gab_value arg = i < have ? PEEK_N(have - i) : MICRO_OP_NIL();
+
+  DROP_N(have + FRAME_SIZE);
+
+  PUSH(arg);
+
+  SET_HV(below_have + 1);
+
+  NEXT();
+}
+
 CASE_CODE(SEND_PROPERTY) {
   gab_value *ks = READ_SENDCONSTANTS;
   uint64_t have = HV();
@@ -14309,10 +15988,33 @@ CASE_CODE(SEND_PROPERTY) {
 
 CASE_CODE(NOP) { NEXT(); }
 
+static_assert(OP_SEND_PRIMITIVE_GTE - OP_SEND_PRIMITIVE_ADD ==
+                  OP_CONSTANT_SEND_PRIMITIVE_GTE -
+                      OP_CONSTANT_SEND_PRIMITIVE_ADD,
+              "Constant sends shall mirror the numeric primitive sends");
+
+/*
+ * Once the send after this constant has specialized into a numeric primitive,
+ * fuse the two together. The constant number is then handed directly to the
+ * primitive, instead of going through the stack.
+ *
+ * @see IMPL_CONSTANT_SEND_BINARY
+ */
 CASE_CODE(CONSTANT) {
   uint64_t have = HV();
 
-  PUSH(READ_CONSTANT);
+  gab_value k = READ_CONSTANT;
+
+  uint8_t next = *IP();
+
+  if (__gab_unlikely(next >= OP_SEND_PRIMITIVE_ADD &&
+                     next <= OP_SEND_PRIMITIVE_GTE)) {
+    if (have == 1 && gab_valisn(k) && gab_valisn(PEEK()))
+      WRITE_BYTE(3, OP_CONSTANT_SEND_PRIMITIVE_ADD +
+                        (next - OP_SEND_PRIMITIVE_ADD));
+  }
+
+  PUSH(k);
 
   SET_HV(have + 1);
 
@@ -14606,7 +16308,10 @@ CASE_CODE(SEND) {
   gab_value m = ks[GAB_SEND_KMESSAGE];
 
   if (BLOCK() && __gab_vmtrysetuplocalmatch(GAB(), m, ks, BLOCK_PROTO())) {
-    WRITE_BYTE(GAB_SEND_CACHE_SIZE, OP_MATCHSEND_BLOCK + adjust);
+    bool isbool = (r == gab_true || r == gab_false) && __gab_vmmatchisbool(ks);
+
+    WRITE_BYTE(GAB_SEND_CACHE_SIZE,
+               (isbool ? OP_MATCHSEND_BOOL : OP_MATCHSEND_BLOCK) + adjust);
     IP() -= GAB_SEND_CACHE_SIZE;
     NEXT();
   }
@@ -14640,14 +16345,25 @@ CASE_CODE(SEND) {
     struct gab_oblock *b = GAB_VAL_TO_BLOCK(spec);
     struct gab_oprototype *p = GAB_VAL_TO_PROTOTYPE(b->p);
 
-    uint8_t local = (BLOCK() && BLOCK_PROTO()->src == p->src);
-    adjust |= (local << 1);
+    switch (__gab_vmtrivialblock(GAB(), p, &ks[GAB_SEND_KSPEC])) {
+    case kTRIVIAL_CONSTANT:
+      WRITE_BYTE(GAB_SEND_CACHE_SIZE, OP_SEND_CONSTANT);
+      break;
+    case kTRIVIAL_ARGUMENT:
+      WRITE_BYTE(GAB_SEND_CACHE_SIZE, OP_SEND_ARGUMENT);
+      break;
+    case kTRIVIAL_NONE: {
+      uint8_t local = (BLOCK() && BLOCK_PROTO()->src == p->src);
+      adjust |= (local << 1);
+
+      if (local) {
+        ks[GAB_SEND_KOFFSET] = (intptr_t)proto_ip(GAB(), p);
+      }
 
-    if (local) {
-      ks[GAB_SEND_KOFFSET] = (intptr_t)proto_ip(GAB(), p);
+      WRITE_BYTE(GAB_SEND_CACHE_SIZE, OP_SEND_BLOCK + adjust);
+      break;
+    }
     }
-
-    WRITE_BYTE(GAB_SEND_CACHE_SIZE, OP_SEND_BLOCK + adjust);
 
     break;
   }
@@ -3,6 +3,7 @@
 
 #include "cgab.h"
 
+#include <math.h>
 #include <stddef.h>
 
 #include "crossline/crossline.c"
@@ -287,41 +288,20 @@ typedef union gab_value_pair(WINAPI *dynlib_fn)(struct gab_triple);
 typedef union gab_value_pair (*dynlib_fn)(struct gab_triple);
 #endif
 
-union gab_value_pair gab_use_dynlib(struct gab_triple gab, const char *path,
-                                    uint64_t len, const char **sargs,
-                                    gab_value *vargs) {
-  gab_osdynlib lib = gab_oslibopen(path);
-
-  if (lib == nullptr) {
-#ifdef GAB_PLATFORM_UNIX
-    return gab_panicf(gab, "Failed to load module.\n\n@", gab_string(gab, path),
-                      gab_string(gab, dlerror()));
-#elifdef GAB_PLATFORM_WASI
-    return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, path));
-#elifdef GAB_PLATFORM_WIN
-    {
-      int error = GetLastError();
-      char buffer[128];
-      if (FormatMessageA(
-              FORMAT_MESSAGE_IGNORE_INSERTS | FORMAT_MESSAGE_FROM_SYSTEM, NULL,
-              error, 0, buffer, sizeof(buffer) / sizeof(char), NULL))
-        return gab_panicf(gab, "Failed to load module '$': $",
-                          gab_string(gab, path), gab_string(gab, buffer));
-
-      return gab_panicf(gab, "Failed to load module '$'",
-                        gab_string(gab, path));
-    }
-#endif
-  }
-
+/*
+ * Run the main function of an opened library. Errors and the module cache
+ * refer to it by 'name', which needn't be the path it was opened from.
+ */
+union gab_value_pair gab_run_dynlib(struct gab_triple gab, gab_osdynlib lib,
+                                    const char *name) {
   dynlib_fn mod = gab_oslibfind(lib, GAB_DYNLIB_MAIN);
 
   if (mod == nullptr)
 #ifdef GAB_PLATFORM_UNIX
     return gab_panicf(gab, "Failed to load module '$': $",
-                      gab_string(gab, path), gab_string(gab, dlerror()));
+                      gab_string(gab, name), gab_string(gab, dlerror()));
 #elifdef GAB_PLATFORM_WASI
-    return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, path));
+    return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, name));
 #elifdef GAB_PLATFORM_WIN
   {
     int error = GetLastError();
@@ -330,9 +310,9 @@ union gab_value_pair gab_use_dynlib(struct gab_triple gab, const char *path,
             FORMAT_MESSAGE_IGNORE_INSERTS | FORMAT_MESSAGE_FROM_SYSTEM, NULL,
             error, 0, buffer, sizeof(buffer) / sizeof(char), NULL))
       return gab_panicf(gab, "Failed to load module '$': $",
-                        gab_string(gab, path), gab_string(gab, buffer));
+                        gab_string(gab, name), gab_string(gab, buffer));
 
-    return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, path));
+    return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, name));
   }
 #endif
 
@@ -350,12 +330,46 @@ union gab_value_pair gab_use_dynlib(struct gab_triple gab, const char *path,
         "Failed to load module. Module returned:\n\n$\n\nExpected:\n\n$\n\n",
         res.aresult[0], gab_ok);
 
-  if (gab_segmodput(gab.eg, path, res.aresult) == nullptr)
+  if (gab_segmodput(gab.eg, name, res.aresult) == nullptr)
     return gab_panicf(gab, "Failed to cache c module.");
 
   return res;
 }
 
+/*
+ * Report why the library 'name' couldn't be opened.
+ */
+union gab_value_pair gab_dynlib_openerr(struct gab_triple gab,
+                                        const char *name) {
+#ifdef GAB_PLATFORM_UNIX
+  return gab_panicf(gab, "Failed to load module.\n\n@", gab_string(gab, name),
+                    gab_string(gab, dlerror()));
+#elifdef GAB_PLATFORM_WASI
+  return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, name));
+#elifdef GAB_PLATFORM_WIN
+  int error = GetLastError();
+  char buffer[128];
+  if (FormatMessageA(FORMAT_MESSAGE_IGNORE_INSERTS | FORMAT_MESSAGE_FROM_SYSTEM,
+                     NULL, error, 0, buffer, sizeof(buffer) / sizeof(char),
+                     NULL))
+    return gab_panicf(gab, "Failed to load module '$': $",
+                      gab_string(gab, name), gab_string(gab, buffer));
+
+  return gab_panicf(gab, "Failed to load module '$'", gab_string(gab, name));
+#endif
+}
+
+union gab_value_pair gab_use_dynlib(struct gab_triple gab, const char *path,
+                                    uint64_t len, const char **sargs,
+                                    gab_value *vargs) {
+  gab_osdynlib lib = gab_oslibopen(path);
+
+  if (lib == nullptr)
+    return gab_dynlib_openerr(gab, path);
+
+  return gab_run_dynlib(gab, lib, path);
+}
+
 union gab_value_pair gab_use_zip_dynlib(struct gab_triple gab, const char *path,
                                         uint64_t len, const char **sargs,
                                         gab_value *vargs) {
@@ -370,6 +384,34 @@ union gab_value_pair gab_use_zip_dynlib(struct gab_triple gab, const char *path,
     return gab_panicf(gab, "Failed to load module: $", gab_string(gab, estr));
   };
 
+#ifdef GAB_PLATFORM_LINUX
+  /*
+   * Load the library straight out of memory. This never touches the disk, so
+   * gab-apps running at the same time can't stomp over each other's
+   * extracted files. If anything goes wrong, fall back to extracting.
+   */
+  size_t sz;
+  void *bytes = mz_zip_reader_extract_to_heap(&zip, idx, &sz, 0);
+
+  if (bytes) {
+    char *memlib = gab_osmemlib(path, sz, bytes);
+    free(bytes);
+
+    if (memlib) {
+      gab_osdynlib lib = gab_oslibopen(memlib);
+
+      // The loader couldn't use the in-memory file, so it needn't stay open.
+      if (lib == nullptr)
+        close(atoi(strrchr(memlib, '/') + 1));
+
+      free(memlib);
+
+      if (lib)
+        return gab_run_dynlib(gab, lib, path);
+    }
+  }
+#endif
+
   v_char temppath = {0};
   v_char_spush(&temppath, s_char_cstr("gab@" GAB_VERSION_TAG "/"));
   v_char_spush(&temppath, s_char_cstr(path));
@@ -413,11 +455,14 @@ union gab_value_pair gab_use_zip_dynlib(struct gab_triple gab, const char *path,
   }
 
 exists:
-  union gab_value_pair res = gab_use_dynlib(gab, dst, len, sargs, vargs);
+  gab_osdynlib lib = gab_oslibopen(dst);
 
   free(dst);
 
-  return res;
+  if (lib == nullptr)
+    return gab_dynlib_openerr(gab, path);
+
+  return gab_run_dynlib(gab, lib, path);
 }
 
 union gab_value_pair gab_use_zip_data(struct gab_triple gab, const char *path,
@@ -818,9 +863,13 @@ int run_bundle(const char *mod, uint64_t argc, const char **argv) {
 }
 
 int run_file(const char *package, int flags, uint32_t wait, uint64_t jobs,
-             uint64_t nmodules, struct gab_package *packages, uint64_t nargs, const char** args) {
+             uint64_t nmodules, struct gab_package *packages, uint64_t nargs, const char** args,
+             FILE *profile) {
   gab_ossignal(SIGINT, propagate_term);
 
+  if (profile)
+    flags |= fGAB_PROFILE;
+
   union gab_value_pair res = gab_create(
       (struct gab_create_argt){
           .wait = wait,
@@ -829,6 +878,7 @@ int run_file(const char *package, int flags, uint32_t wait, uint64_t jobs,
           .roots = roots,
           .resources = native_file_resources,
           .flags = flags,
+          .profile = profile,
       },
       &gab);
 
@@ -868,6 +918,82 @@ int run_file(const char *package, int flags, uint32_t wait, uint64_t jobs,
   return gab_destroy(gab), 0;
 }
 
+uint64_t now_ns() {
+  struct timespec ts;
+#ifdef TIME_MONOTONIC
+  timespec_get(&ts, TIME_MONOTONIC);
+#else
+  timespec_get(&ts, TIME_UTC);
+#endif
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * A single measurement of a benchmark - one run in a fresh engine.
+ */
+struct bench_sample {
+  double wall_ns, allocations, epochs;
+};
+
+int run_bench_once(const char *package, int flags, uint32_t wait,
+                   uint64_t jobs, uint64_t nmodules,
+                   struct gab_package *packages, struct bench_sample *out) {
+  union gab_value_pair res = gab_create(
+      (struct gab_create_argt){
+          .wait = wait,
+          .jobs = jobs,
+          .packages = packages,
+          .roots = roots,
+          .resources = native_file_resources,
+          .flags = flags,
+      },
+      &gab);
+
+  if (!check_and_printerr(&res))
+    return gab_destroy(gab), 1;
+
+  uint64_t len = gab_varrlen(res.aresult);
+  gab_assert(len - 1 == nmodules, "Found %lu modules, expected %lu", len - 1,
+             nmodules);
+
+  const char *sargs[len];
+  for (int i = 0; i < len; i++)
+    sargs[i] = packages[i].alias    ? packages[i].alias
+               : packages[i].module ? packages[i].module
+                                    : packages[i].package;
+  sargs[len - 1] = "Process";
+
+  gab_value vargs[len];
+  memcpy(vargs, res.aresult + 1, (len - 1) * sizeof(gab_value));
+  vargs[len - 1] = build_process_module(gab, 0, nullptr);
+
+  // Only the benchmark itself is measured - not booting the engine.
+  struct gab_gcstats before, after;
+  gab_gcstats(gab, &before);
+  uint64_t start = now_ns();
+
+  union gab_value_pair run_res = gab_use(gab, (struct gab_use_argt){
+                                                  .flags = flags,
+                                                  .spackage_name = package,
+                                                  .len = len,
+                                                  .sargv = sargs,
+                                                  .argv = vargs,
+                                              });
+
+  bool ok = check_and_printerr(&run_res);
+
+  uint64_t end = now_ns();
+  gab_gcstats(gab, &after);
+
+  *out = (struct bench_sample){
+      .wall_ns = end - start,
+      .allocations = after.allocations - before.allocations,
+      .epochs = after.collections - before.collections,
+  };
+
+  return gab_destroy(gab), !ok;
+}
+
 bool add_package(mz_zip_archive *zip_o, const char **roots,
                  const struct gab_resource *resources, s_char package,
                  struct gab_module_res *mod) {
@@ -898,10 +1024,18 @@ bool add_package(mz_zip_archive *zip_o, const char **roots,
     }
   }
 
+  /*
+   * Native modules are stored as-is. They barely compress, and stored entries
+   * are extracted with a plain copy when the bundle is loaded.
+   */
+  mz_uint level = mod->resource && mod->resource->loader == gab_use_dynlib
+                      ? MZ_NO_COMPRESSION
+                      : MZ_BEST_SPEED;
+
   // TODO @cli @qol: Allow the user to configure the SPEED/COMPRESSION tradeoff
   // here.
   return mz_zip_writer_add_file(zip_o, mod->package_path, mod->path, nullptr, 0,
-                                MZ_BEST_SPEED);
+                                level);
 }
 
 struct step {
@@ -1331,8 +1465,8 @@ int execute_steps(int len, struct step steps[len], bool noisy) {
 }
 
 struct command_arguments {
-  uint32_t argc, flags, wait, njobs;
-  const char **argv, *platform, *dynlib_fileending;
+  uint32_t argc, flags, wait, njobs, runs, limit;
+  const char **argv, *platform, *dynlib_fileending, *out, *baseline, *profile;
   v_s_char packages;
   v_s_char package_aliases;
 };
@@ -1366,6 +1500,7 @@ int help(struct command_arguments *args);
 int welcome(struct command_arguments *args);
 int build(struct command_arguments *args);
 int info(struct command_arguments *args);
+int bench(struct command_arguments *args);
 
 #define DEFAULT_COMMAND commands[0]
 
@@ -1376,6 +1511,7 @@ enum cliflag {
   FLAG_BUILD_TARGET = 1 << 4,
   FLAG_STEP_AUTOCONFIRM = 1 << 5,
   FLAG_STEP_VERBOSE = 1 << 6,
+  FLAG_OPTIMIZE = fGAB_OPTIMIZE,
 };
 
 const struct option dumpast_option = {
@@ -1392,6 +1528,13 @@ const struct option dumpbytecode_option = {
     .flag = FLAG_DUMP_BC,
 };
 
+const struct option optimize_option = {
+    "optimize",
+    "Fold constants and drop dead tuples before compiling",
+    'O',
+    .flag = FLAG_OPTIMIZE,
+};
+
 const struct option structured_err_option = {
     "sterr",
     "Instead of pretty-printing errors, use a structured output",
@@ -1526,6 +1669,89 @@ int module_handler(struct command_arguments *args) {
   return 0;
 }
 
+int runs_handler(struct command_arguments *args) {
+  const char *flag = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  if (args->argc <= 0)
+    return missing_flag_argument_error(flag, "runs");
+
+  const char *runs = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  uint32_t nruns = atoll(runs);
+  if (nruns == 0) {
+    clierror("Specify a number of runs greater than 0.");
+    return 1;
+  }
+
+  args->runs = nruns;
+  return 0;
+}
+
+int limit_handler(struct command_arguments *args) {
+  const char *flag = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  if (args->argc <= 0)
+    return missing_flag_argument_error(flag, "percent");
+
+  const char *limit = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  args->limit = atoll(limit);
+  return 0;
+}
+
+int out_handler(struct command_arguments *args) {
+  const char *flag = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  if (args->argc <= 0)
+    return missing_flag_argument_error(flag, "file");
+
+  args->out = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  return 0;
+}
+
+int profile_handler(struct command_arguments *args) {
+  const char *flag = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  if (args->argc <= 0)
+    return missing_flag_argument_error(flag, "file");
+
+  args->profile = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  return 0;
+}
+
+int baseline_handler(struct command_arguments *args) {
+  const char *flag = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  if (args->argc <= 0)
+    return missing_flag_argument_error(flag, "file");
+
+  args->baseline = *args->argv;
+  args->argv++;
+  args->argc--;
+
+  return 0;
+}
+
 const struct option busywait_option = {
     "busy",
     "Configure gab's behavior while 'busy-waiting'",
@@ -1563,6 +1789,42 @@ const struct option jobs_option = {
     .handler_f = jobs_handler,
 };
 
+const struct option profile_option = {
+    "profile",
+    "Sample running fibers, and write collapsed stacks for a flamegraph to "
+    "the given file",
+    'p',
+    .handler_f = profile_handler,
+};
+
+const struct option runs_option = {
+    "runs",
+    "Run each benchmark this many times",
+    'r',
+    .handler_f = runs_handler,
+};
+
+const struct option out_option = {
+    "out",
+    "Write the results as json to the given file",
+    'o',
+    .handler_f = out_handler,
+};
+
+const struct option baseline_option = {
+    "base",
+    "Compare the results against a json baseline, written by --out",
+    'b',
+    .handler_f = baseline_handler,
+};
+
+const struct option limit_option = {
+    "limit",
+    "Fail when a median regresses by more than this percent (default 10)",
+    'l',
+    .handler_f = limit_handler,
+};
+
 static struct command commands[] =
     {
         {
@@ -1642,11 +1904,14 @@ static struct command commands[] =
             "info",
             "Log information about the local gab environment.",
             // clang-format off
-            "\tDump compile-time configuration about this binary, as well as list the targets installed locally",
+            "\tDump compile-time configuration about this binary, as well as list the targets installed locally.\n\n"
+            "\tWith the <arg> 'gc', instead boot an engine with the default modules and report on its heap\n"
+            "\tand garbage collector - live objects per kind, collection and pause times, and buffer high-water marks.",
             // clang-format on
             .example =
                 {
                     GREEN("gab") " " YELLOW("info"),
+                    GREEN("gab") " " YELLOW("info") " gc",
                 },
             .handler = info,
         },
@@ -1716,10 +1981,12 @@ static struct command commands[] =
             {
                 dumpast_option,
                 dumpbytecode_option,
+                optimize_option,
                 structured_err_option,
                 modules_option,
                 busywait_option,
                 jobs_option,
+                profile_option,
             },
         },
         {
@@ -1735,12 +2002,44 @@ static struct command commands[] =
             {
                 dumpast_option,
                 dumpbytecode_option,
+                optimize_option,
                 structured_err_option,
                 modules_option,
                 busywait_option,
                 jobs_option,
             },
         },
+        {
+            "bench",
+            "Benchmark the modules given by <args>",
+            // clang-format off
+            "\tRun each module in <args> several times, each time in a fresh engine.\n"
+            "\tWith no <args>, run the benchmarks in " CYAN("bench/") ": fib, dispatch, reduce, record_update, ring and spawn.\n\n"
+            "\tOnly the module itself is measured, not booting the engine. For each benchmark, gab reports the\n"
+            "\tmedian, p95 and standard deviation of:\n\n"
+              "\t\t" CYAN("wall time") "\n"
+              "\t\t" CYAN("objects allocated") "\n"
+              "\t\t" CYAN("gc epochs") "\n\n"
+            "\tThe results may be written as json with --out. A file written this way can be\n"
+            "\tgiven to a later run with --base. gab then exits with an error if the median wall time\n"
+            "\tor allocations of any benchmark regress by more than --limit percent.",
+            // clang-format on
+            .example =
+                {
+                    GREEN("gab") " " YELLOW("bench") " -r 20 -o base.json",
+                    GREEN("gab") " " YELLOW("bench") " -b base.json -l 5 bench/fib/fib",
+                },
+            .handler = bench,
+            {
+                runs_option,
+                out_option,
+                baseline_option,
+                limit_option,
+                modules_option,
+                busywait_option,
+                jobs_option,
+            },
+        },
         {
             "repl",
             "Enter the REPL",
@@ -1756,6 +2055,7 @@ static struct command commands[] =
             {
                 dumpast_option,
                 dumpbytecode_option,
+                optimize_option,
                 modules_option,
                 busywait_option,
                 jobs_option,
@@ -1797,6 +2097,8 @@ struct command_arguments parse_options(int argc, const char **argv,
       .wait = cGAB_DEFAULT_WAIT_NS,
       .platform = GAB_TARGET_TRIPLE,
       .dynlib_fileending = GAB_DYNLIB_FILEENDING,
+      .runs = 10,
+      .limit = 10,
       .flags = fGAB_SIGTERM_ON_ERR,
   };
 
@@ -1814,8 +2116,9 @@ struct command_arguments parse_options(int argc, const char **argv,
 
         if (opt.name && !strcmp(arg + 2, opt.name)) {
           if (opt.handler_f) {
-            if (!opt.handler_f(&args))
-              exit(1);
+            int result = opt.handler_f(&args);
+            if (result)
+              exit(result);
           } else {
             args.flags |= opt.flag, args.argc--, args.argv++;
           }
@@ -2224,8 +2527,24 @@ int run(struct command_arguments *args) {
   v_pkg modules = {0};
   int nmodules = init_modules(&modules, args);
 
+  FILE *profile = nullptr;
+
+  if (args->profile) {
+    profile = fopen(args->profile, "w");
+
+    if (!profile) {
+      v_pkg_destroy(&modules);
+      return clierror("Could not open " YELLOW("%s") " for writing.",
+                      args->profile),
+             1;
+    }
+  }
+
   int res = run_file(mod, args->flags, args->wait, args->njobs, nmodules - 1,
-                     modules.data, args->argc, args->argv);
+                     modules.data, args->argc, args->argv, profile);
+
+  if (profile)
+    fclose(profile);
 
   v_pkg_destroy(&modules);
 
@@ -2262,6 +2581,198 @@ int repl(struct command_arguments *args) {
   return res;
 }
 
+const char *default_benchmarks[] = {
+    "bench/fib/fib",       "bench/dispatch/dispatch",
+    "bench/reduce/reduce", "bench/record_update/record_update",
+    "bench/ring/ring",     "bench/spawn/spawn",
+};
+
+struct bench_summary {
+  double median, p95, stddev;
+};
+
+int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+struct bench_summary summarize(uint64_t len, double samples[len]) {
+  double sorted[len];
+  memcpy(sorted, samples, sizeof(sorted));
+  qsort(sorted, len, sizeof(double), cmp_double);
+
+  double mean = 0;
+  for (uint64_t i = 0; i < len; i++)
+    mean += sorted[i];
+  mean /= len;
+
+  double variance = 0;
+  for (uint64_t i = 0; i < len; i++)
+    variance += (sorted[i] - mean) * (sorted[i] - mean);
+  variance = len > 1 ? variance / (len - 1) : 0;
+
+  // Nearest-rank percentile.
+  uint64_t p95 = (95 * len + 99) / 100;
+
+  return (struct bench_summary){
+      .median = len % 2 ? sorted[len / 2]
+                        : (sorted[len / 2 - 1] + sorted[len / 2]) / 2,
+      .p95 = sorted[p95 ? p95 - 1 : 0],
+      .stddev = sqrt(variance),
+  };
+}
+
+struct bench_result {
+  const char *name;
+  struct bench_summary wall_ns, allocations, epochs;
+};
+
+void fprint_summary(FILE *stream, const char *key, struct bench_summary s) {
+  fprintf(stream,
+          "\"%s\": {\"median\": %.0f, \"p95\": %.0f, \"stddev\": %.2f}", key,
+          s.median, s.p95, s.stddev);
+}
+
+/*
+ * Each benchmark is written on its own line, so that a baseline can be read
+ * back without a json parser. @see baseline_median
+ */
+int write_results(const char *path, uint32_t runs, uint64_t len,
+                  struct bench_result results[len]) {
+  FILE *f = fopen(path, "w");
+
+  if (!f)
+    return clierror("Could not open '%s' for writing.\n", path), 1;
+
+  fprintf(f, "{\n  \"version\": \"%s\",\n  \"target\": \"%s\",\n",
+          GAB_VERSION_TAG, GAB_TARGET_TRIPLE);
+  fprintf(f, "  \"runs\": %u,\n  \"benchmarks\": [\n", runs);
+
+  for (uint64_t i = 0; i < len; i++) {
+    fprintf(f, "    {\"name\": \"%s\", ", results[i].name);
+    fprint_summary(f, "wall_ns", results[i].wall_ns);
+    fprintf(f, ", ");
+    fprint_summary(f, "allocations", results[i].allocations);
+    fprintf(f, ", ");
+    fprint_summary(f, "epochs", results[i].epochs);
+    fprintf(f, "}%s\n", i + 1 < len ? "," : "");
+  }
+
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+  return 0;
+}
+
+/*
+ * Find the median of the given metric for the benchmark named name, in a
+ * baseline written by write_results.
+ */
+bool baseline_median(const char *baseline, const char *name,
+                     const char *metric, double *out) {
+  char key[1024];
+  snprintf(key, sizeof(key), "{\"name\": \"%s\",", name);
+
+  const char *line = strstr(baseline, key);
+  if (!line)
+    return false;
+
+  const char *eol = strchr(line, '\n');
+
+  snprintf(key, sizeof(key), "\"%s\": {\"median\": ", metric);
+
+  const char *value = strstr(line, key);
+  if (!value || (eol && value > eol))
+    return false;
+
+  return sscanf(value + strlen(key), "%lf", out) == 1;
+}
+
+bool check_regression(const char *name, const char *metric, double base,
+                      double median, uint32_t limit) {
+  if (median <= base * (1 + limit / 100.0))
+    return false;
+
+  clierror("%s: median %s regressed from %.0f to %.0f (limit %u%%).\n", name,
+           metric, base, median, limit);
+  return true;
+}
+
+int bench(struct command_arguments *args) {
+  uint64_t nbenches = args->argc ? args->argc : LEN_CARRAY(default_benchmarks);
+  const char **benches = args->argc ? args->argv : default_benchmarks;
+
+  a_char *baseline = nullptr;
+  if (args->baseline) {
+    baseline = gab_osread(args->baseline);
+
+    if (!baseline)
+      return clierror("Could not read baseline '%s'.\n", args->baseline), 1;
+  }
+
+  v_pkg modules = {0};
+  int nmodules = init_modules(&modules, args);
+
+  struct bench_result results[nbenches];
+  int res = 0;
+
+  for (uint64_t i = 0; i < nbenches; i++) {
+    double wall[args->runs], allocs[args->runs], epochs[args->runs];
+
+    for (uint32_t r = 0; r < args->runs; r++) {
+      struct bench_sample sample;
+
+      if (run_bench_once(benches[i], args->flags, args->wait, args->njobs,
+                         nmodules - 1, modules.data, &sample)) {
+        clierror("Benchmark '%s' failed.\n", benches[i]);
+        res = 1;
+        goto fin;
+      }
+
+      wall[r] = sample.wall_ns;
+      allocs[r] = sample.allocations;
+      epochs[r] = sample.epochs;
+    }
+
+    results[i] = (struct bench_result){
+        .name = benches[i],
+        .wall_ns = summarize(args->runs, wall),
+        .allocations = summarize(args->runs, allocs),
+        .epochs = summarize(args->runs, epochs),
+    };
+
+    struct bench_result *r = results + i;
+    printf("%-34s | %10.3f ms (p95 %.3f, sd %.3f) | %10.0f allocs | "
+           "%5.0f epochs\n",
+           r->name, r->wall_ns.median / 1e6, r->wall_ns.p95 / 1e6,
+           r->wall_ns.stddev / 1e6, r->allocations.median, r->epochs.median);
+
+    if (!baseline)
+      continue;
+
+    double base;
+    if (baseline_median(baseline->data, r->name, "wall_ns", &base))
+      res |= check_regression(r->name, "wall time", base, r->wall_ns.median,
+                              args->limit);
+    else
+      cliwarn("No baseline for benchmark '%s'.\n", r->name);
+
+    if (baseline_median(baseline->data, r->name, "allocations", &base))
+      res |= check_regression(r->name, "allocations", base,
+                              r->allocations.median, args->limit);
+  }
+
+  if (args->out)
+    res |= write_results(args->out, args->runs, nbenches, results);
+
+fin:
+  if (baseline)
+    a_char_destroy(baseline);
+
+  v_pkg_destroy(&modules);
+
+  return res;
+}
+
 void cmd_summary(int i) {
   struct command cmd = commands[i];
   printf("\n\t" GREEN("gab") " " YELLOW("%-8s") " [opts] <args>\t%s", cmd.name,
@@ -2332,6 +2843,7 @@ struct {
     {"max frames", STR(cGAB_FRAMES_MAX)},
     {"max stack", STR(cGAB_STACK_MAX)},
     {"res stack", STR(cGAB_RESOURCE_MAX)},
+    {"gc rc-cache len", STR(cGAB_GC_RC_CACHE_LEN)},
 };
 
 struct {
@@ -2363,7 +2875,93 @@ struct {
     },
 };
 
+void print_hist(const char *name, uint64_t hist[GAB_GCSTATS_NBUCKETS]) {
+  printf("%17s |", name);
+
+  for (int i = 0; i < GAB_GCSTATS_NBUCKETS; i++)
+    printf(" %lu", hist[i]);
+
+  printf("\n");
+}
+
+/*
+ * Boot an engine with the default modules, and report on the heap
+ * it leaves behind.
+ */
+int info_gc(struct command_arguments *args) {
+  union gab_value_pair res = gab_create(
+      (struct gab_create_argt){
+          .packages = default_modules,
+          .roots = roots,
+          .resources = native_file_resources,
+      },
+      &gab);
+
+  if (!check_and_printerr(&res))
+    return gab_destroy(gab), 1;
+
+  // The second signal can only be sent once the first collection is done.
+  gab_sigcoll(gab);
+  gab_sigcoll(gab);
+
+  struct gab_gcstats stats;
+  gab_gcstats(gab, &stats);
+
+  printf("%17s\n", SECTION("HEAP") "\n");
+
+  int64_t objects = 0, bytes = 0;
+  for (int k = 0; k < kGAB_NKINDS; k++) {
+    if (!stats.objects[k])
+      continue;
+
+    char name[64];
+    if (gab_sprintf(name, sizeof(name), "$", gab_type(gab, k)) < 0)
+      name[0] = '\0';
+
+    printf("%17s | %li objects, %li bytes\n", name, stats.objects[k],
+           stats.bytes[k]);
+
+    objects += stats.objects[k];
+    bytes += stats.bytes[k];
+  }
+
+  printf("%17s | %li objects, %li bytes\n", "total", objects, bytes);
+
+  printf("\n%17s\n", SECTION("GC") "\n");
+  printf("%17s | %lu\n", "collections", stats.collections);
+  printf("%17s | %lu explicit, %lu buffer\n", "triggers",
+         stats.triggers[kGAB_GCTRIGGER_EXPLICIT],
+         stats.triggers[kGAB_GCTRIGGER_BUFFER]);
+  printf("%17s | %lu ns total, %lu ns max\n", "collect", stats.collect_ns,
+         stats.collect_max_ns);
+  print_hist("collect hist", stats.collect_hist);
+  printf("%17s | %lu ns total, %lu ns max\n", "pause", stats.pause_ns,
+         stats.pause_max_ns);
+  print_hist("pause hist", stats.pause_hist);
+  printf("%17s | %lu\n", "dead", stats.dead);
+  printf("%17s | %lu\n", "overflow rc", stats.overflow_rc);
+
+  printf("\n%17s\n", SECTION("GC BUFFERS") "\n");
+  for (uint64_t i = 0; i < stats.njobs; i++) {
+    struct gab_gcjobstats job;
+    gab_gcjobstats(gab, i, &job);
+
+    printf("%15s%2lu | stk %lu, inc %lu, dec %lu, young %lu\n", "job ", i,
+           job.stack_hwm, job.inc_hwm, job.dec_hwm, job.young_hwm);
+  }
+
+  return gab_destroy(gab), 0;
+}
+
 int info(struct command_arguments *args) {
+  if (args->argc > 0) {
+    if (!strcmp(args->argv[0], "gc"))
+      return info_gc(args);
+
+    clierror("Unrecognized info section '%s'.\n", args->argv[0]);
+    return 1;
+  }
+
   printf("%17s\n", SECTION("CONFIGURATION") "\n");
 
   for (int i = 0; i < LEN_CARRAY(compile_info); i++) {
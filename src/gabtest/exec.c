@@ -1,3 +1,6 @@
+#include <stdlib.h>
+#include <string.h>
+
 #include "cgab.h"
 #include "munit/munit.h"
 
@@ -48,6 +51,32 @@ static MunitResult test_exec_source(const MunitParameter params[], void *data) {
           {.source = "42", .name = "exec_test_simple"},
           {gab_cvalid, gab_ok, gab_number(42)},
       },
+      // COMPILE PASS WITH OPTIMIZATIONS
+      {
+          {
+              .source = "x := 3\n1 2\nx * (2 + 5)",
+              .name = "exec_test_optimize_fold",
+              .flags = fGAB_OPTIMIZE,
+          },
+          {gab_cvalid, gab_ok, gab_number(21)},
+      },
+      {
+          // Locals which are bound more than once are not propagated
+          {
+              .source = "x := 3\nx := x + 1\nx < 2",
+              .name = "exec_test_optimize_rebind",
+              .flags = fGAB_OPTIMIZE,
+          },
+          {gab_cvalid, gab_ok, gab_false},
+      },
+      {
+          // Repeated sends fuse their constant operands into the primitive
+          {
+              .source = "f := x :: x * 2 - 1\nf.(f.(f.(3)))",
+              .name = "exec_test_constant_send",
+          },
+          {gab_cvalid, gab_ok, gab_number(17)},
+      },
       // COMPILE PASS RUNTIME FAIL
       {
           // Cannot add strings to numbers
@@ -226,6 +255,40 @@ static MunitResult test_exec_source(const MunitParameter params[], void *data) {
   return MUNIT_OK;
 }
 
+static MunitResult test_optimize_shrinks(const MunitParameter params[],
+                                         void *data) {
+  // The literal tuple is dropped along with its trim, and 2 + 5 is folded.
+  const char *source = "x := 3\n1 2\nx * (2 + 5)";
+
+  union gab_value_pair plain = gab_build(gab, (struct gab_parse_argt){
+                                                  .source = source,
+                                                  .name = "test_build_plain",
+                                              });
+
+  munit_assert_uint64(plain.status, ==, gab_cvalid);
+
+  union gab_value_pair optimized =
+      gab_build(gab, (struct gab_parse_argt){
+                         .source = source,
+                         .name = "test_build_optimized",
+                         .flags = fGAB_OPTIMIZE,
+                     });
+
+  munit_assert_uint64(optimized.status, ==, gab_cvalid);
+
+  munit_assert_uint64(gab_prtlen(gab_blkproto(optimized.vresult)), <,
+                      gab_prtlen(gab_blkproto(plain.vresult)));
+
+  union gab_value_pair run_res =
+      gab_run(gab, (struct gab_run_argt){.main = optimized.vresult});
+
+  munit_assert_uint64(run_res.status, ==, gab_cvalid);
+  munit_assert_uint64(run_res.aresult[0], ==, gab_ok);
+  munit_assert_uint64(run_res.aresult[1], ==, gab_number(21));
+
+  return MUNIT_OK;
+}
+
 static MunitResult test_run_block(const MunitParameter params[], void *data) {
 
   struct gab_parse_argt build_args = {
@@ -285,7 +348,275 @@ static MunitResult test_send_message(const MunitParameter params[],
   return MUNIT_OK;
 }
 
+static gab_value exec_block(const char *source) {
+  union gab_value_pair res = gab_exec(gab, (struct gab_exec_argt){
+                                               .source = source,
+                                               .name = "test_trivial_block",
+                                           });
+
+  munit_assert_uint64(res.status, ==, gab_cvalid);
+  munit_assert_uint64(res.aresult[0], ==, gab_ok);
+  munit_assert_uint64(gab_valkind(res.aresult[1]), ==, kGAB_BLOCK);
+
+  return res.aresult[1];
+}
+
+static MunitResult test_send_trivial(const MunitParameter params[],
+                                     void *data) {
+  gab_value t = gab_type(gab, kGAB_NUMBER);
+
+  gab_def(gab,
+          {
+              gab_message(gab, "trivial\\arg"),
+              t,
+              exec_block("n :: n"),
+          },
+          {
+              gab_message(gab, "trivial\\k"),
+              t,
+              exec_block("() :: 'k'"),
+          },
+          {
+              // Begins like a trivial block, but isn't one.
+              gab_message(gab, "trivial\\send"),
+              t,
+              exec_block("x :: x .trivial\\k"),
+          }, );
+
+  /*
+   * Each send is run twice from the same site - the first specializes it, and
+   * the second runs the specialized op.
+   */
+  struct exec_test exec_test_cases[] = {
+      {
+          {
+              .source = "f := () :: 1.trivial\\arg 7\nf.()\nf.()",
+              .name = "exec_test_trivial_argument",
+          },
+          {gab_cvalid, gab_ok, gab_number(7)},
+      },
+      {
+          {
+              .source = "f := () :: 1.trivial\\k\nf.()\nf.()",
+              .name = "exec_test_trivial_constant",
+          },
+          {gab_cvalid, gab_ok, gab_string(gab, "k")},
+      },
+      {
+          {
+              .source = "f := () :: 1.trivial\\send 3\nf.()\nf.()",
+              .name = "exec_test_trivial_none",
+          },
+          {gab_cvalid, gab_ok, gab_string(gab, "k")},
+      },
+  };
+
+  for (uint64_t i = 0; i < LEN_CARRAY(exec_test_cases); i++) {
+    struct exec_test testcase = exec_test_cases[i];
+
+    union gab_value_pair result = gab_exec(gab, testcase.in);
+    munit_assert_uint64(result.status, ==, testcase.result[0]);
+
+    for (uint64_t j = 1; j < LEN_CARRAY(testcase.result); j++)
+      if (testcase.result[j])
+        munit_assert_uint64(result.aresult[j - 1], ==, testcase.result[j]);
+  }
+
+  return MUNIT_OK;
+}
+
 // Map the tests to the munit array
+static MunitResult test_recomplete(const MunitParameter params[],
+                                   void *data) {
+  /*
+   * A source which already exists isn't lexed again. Each exec compiles its
+   * code once more into the same source, and completes it again - while the
+   * first block keeps running.
+   */
+  struct gab_exec_argt args = {
+      .source = "x :: x * 2",
+      .name = "exec_test_recomplete",
+  };
+
+  union gab_value_pair first = gab_exec(gab, args);
+
+  munit_assert_uint64(first.status, ==, gab_cvalid);
+  munit_assert_uint64(first.aresult[0], ==, gab_ok);
+
+  for (uint64_t i = 0; i < 32; i++) {
+    union gab_value_pair more = gab_exec(gab, args);
+
+    munit_assert_uint64(more.status, ==, gab_cvalid);
+    munit_assert_uint64(more.aresult[0], ==, gab_ok);
+
+    gab_value blocks[] = {first.aresult[1], more.aresult[1]};
+
+    for (uint64_t j = 0; j < LEN_CARRAY(blocks); j++) {
+      gab_value arg = gab_number(i);
+
+      union gab_value_pair run =
+          gab_run(gab, (struct gab_run_argt){
+                           .main = blocks[j], .len = 1, .argv = &arg});
+
+      munit_assert_uint64(run.status, ==, gab_cvalid);
+      munit_assert_uint64(run.aresult[0], ==, gab_ok);
+      munit_assert_uint64(run.aresult[1], ==, gab_number(i * 2));
+    }
+  }
+
+  return MUNIT_OK;
+}
+
+static MunitResult test_send_bool(const MunitParameter params[], void *data) {
+  /*
+   * The cases must come from the same source as the sends, for the sends to
+   * match on them locally. One caller sends in tail position, and the other
+   * doesn't.
+   */
+  union gab_value_pair res = gab_exec(
+      gab, (struct gab_exec_argt){
+               .source = "t := () :: 'yes'\n"
+                         "f := () :: 'no'\n"
+                         "d := () :: 'any'\n"
+                         "tail := r :: r.test\\bool_case\n"
+                         "nontail := r :: do\n"
+                         "  x := r.test\\bool_case\n"
+                         "  x\n"
+                         "end\n"
+                         "(t, f, d, tail, nontail)",
+               .name = "exec_test_send_bool",
+           });
+
+  munit_assert_uint64(res.status, ==, gab_cvalid);
+  munit_assert_uint64(res.aresult[0], ==, gab_ok);
+
+  gab_value m = gab_message(gab, "test\\bool_case");
+
+  gab_def(gab, {m, gab_true, res.aresult[1]}, {m, gab_false, res.aresult[2]},
+          {m, gab_cundefined, res.aresult[3]}, );
+
+  gab_value callers[] = {res.aresult[4], res.aresult[5]};
+
+  // Each receiver is sent twice, so that the second send runs whatever the
+  // first specialized into. The booleans after the number check that
+  // missing the fast path doesn't break the site.
+  struct {
+    gab_value receiver;
+    const char *expected;
+  } sends[] = {
+      {gab_true, "yes"},       {gab_true, "yes"},  {gab_false, "no"},
+      {gab_false, "no"},       {gab_number(42), "any"},
+      {gab_number(42), "any"}, {gab_true, "yes"},  {gab_false, "no"},
+  };
+
+  for (uint64_t i = 0; i < LEN_CARRAY(callers); i++) {
+    for (uint64_t j = 0; j < LEN_CARRAY(sends); j++) {
+      union gab_value_pair run = gab_run(gab, (struct gab_run_argt){
+                                                  .main = callers[i],
+                                                  .len = 1,
+                                                  .argv = &sends[j].receiver,
+                                              });
+
+      munit_assert_uint64(run.status, ==, gab_cvalid);
+      munit_assert_uint64(run.aresult[0], ==, gab_ok);
+      munit_assert_uint64(run.aresult[1], ==,
+                          gab_string(gab, sends[j].expected));
+    }
+  }
+
+  return MUNIT_OK;
+}
+
+static gab_value exec_block_in(struct gab_triple gab, const char *source) {
+  union gab_value_pair res = gab_exec(gab, (struct gab_exec_argt){
+                                               .source = source,
+                                               .name = "test_profile",
+                                           });
+
+  munit_assert_uint64(res.status, ==, gab_cvalid);
+  munit_assert_uint64(res.aresult[0], ==, gab_ok);
+  munit_assert_uint64(gab_valkind(res.aresult[1]), ==, kGAB_BLOCK);
+
+  return res.aresult[1];
+}
+
+static MunitResult test_profile(const MunitParameter params[], void *data) {
+  FILE *out = tmpfile();
+  munit_assert_not_null(out);
+
+  // A single job, so that each distinct stack is written exactly once.
+  struct gab_triple prof;
+  union gab_value_pair created = gab_create(
+      (struct gab_create_argt){
+          .jobs = 1,
+          .profile = out,
+      },
+      &prof);
+
+  munit_assert_uint64(created.status, ==, gab_cvalid);
+
+  gab_def(prof,
+          {
+              gab_message(prof, "prof\\fib"),
+              gab_type(prof, kGAB_NUMBER),
+              exec_block_in(prof, "() :: (self < 2).prof\\do_fib self"),
+          },
+          {
+              gab_message(prof, "prof\\do_fib"),
+              gab_true,
+              exec_block_in(prof, "n :: n"),
+          },
+          {
+              gab_message(prof, "prof\\do_fib"),
+              gab_false,
+              exec_block_in(prof,
+                            "n :: (n - 1).prof\\fib + (n - 2).prof\\fib"),
+          }, );
+
+  union gab_value_pair result =
+      gab_exec(prof, (struct gab_exec_argt){
+                         .source = "25.prof\\fib",
+                         .name = "test_profile",
+                         .flags = fGAB_PROFILE,
+                     });
+
+  munit_assert_uint64(result.status, ==, gab_cvalid);
+  munit_assert_uint64(result.aresult[0], ==, gab_ok);
+  munit_assert_uint64(result.aresult[1], ==, gab_number(75025));
+
+  gab_destroy(prof);
+
+  rewind(out);
+
+  char lines[64][4096];
+  uint64_t nlines = 0;
+
+  while (nlines < LEN_CARRAY(lines) &&
+         fgets(lines[nlines], sizeof(lines[nlines]), out)) {
+    char *line = lines[nlines];
+
+    // <frame>;<frame>;... <weight>
+    char *weight = strrchr(line, ' ');
+    munit_assert_not_null(weight);
+    munit_assert_uint64(strtoull(weight + 1, nullptr, 10), >, 0);
+    *weight = '\0';
+
+    // Every frame is written as <module>:<line>:<token>
+    munit_assert_ptr_equal(strstr(line, "test_profile:"), line);
+
+    // Stacks with the same frames are merged into one line.
+    for (uint64_t i = 0; i < nlines; i++)
+      munit_assert_string_not_equal(lines[i], line);
+
+    nlines++;
+  }
+
+  munit_assert_uint64(nlines, >, 0);
+
+  fclose(out);
+  return MUNIT_OK;
+}
+
 static MunitTest exec_tests[] = {
     {
         "/parse_compile",
@@ -303,6 +634,14 @@ static MunitTest exec_tests[] = {
         MUNIT_TEST_OPTION_NONE,
         NULL,
     },
+    {
+        "/optimize_shrinks",
+        test_optimize_shrinks,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
     {
         "/run_block",
         test_run_block,
@@ -319,6 +658,38 @@ static MunitTest exec_tests[] = {
         MUNIT_TEST_OPTION_NONE,
         NULL,
     },
+    {
+        "/send_trivial",
+        test_send_trivial,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {
+        "/recomplete",
+        test_recomplete,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {
+        "/send_bool",
+        test_send_bool,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {
+        "/profile",
+        test_profile,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
     {},
 };
 
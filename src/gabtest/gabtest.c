@@ -12,6 +12,8 @@ extern const MunitSuite string_suite;
 extern const MunitSuite binary_suite;
 extern const MunitSuite channel_suite;
 extern const MunitSuite exec_suite;
+extern const MunitSuite gc_suite;
+extern const MunitSuite resolve_suite;
 
 struct gab_triple gab;
 
@@ -33,6 +35,8 @@ int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
       binary_suite,
       channel_suite,
       exec_suite,
+      gc_suite,
+      resolve_suite,
       {},
   };
 
@@ -0,0 +1,106 @@
+#include "cgab.h"
+#include "munit/munit.h"
+
+extern struct gab_triple gab;
+
+/*
+ * Yield until a collection which was already signalled has finished, without
+ * asking for another. Gives up after a while, so that a missing collection
+ * fails the test instead of hanging it.
+ */
+static void wait_for_collection(struct gab_gcstats *stats, uint64_t after) {
+  for (int i = 0; i < (1 << 20) && stats->collections <= after; i++) {
+    switch (gab_yield(gab)) {
+    case sGAB_COLL:
+      gab_gcepochnext(gab);
+      gab_sigpropagate(gab);
+      break;
+    default:
+      break;
+    }
+
+    gab_gcstats(gab, stats);
+  }
+}
+
+static MunitResult test_young_budget(const MunitParameter params[],
+                                     void *data) {
+  struct gab_gcstats before, after;
+  gab_gcstats(gab, &before);
+
+  // Temporaries which are never stored raise no rc events. Only the young
+  // budget can trigger a collection here.
+  for (uint64_t i = 0; i < cGAB_GC_YOUNG_MAX + 1; i++)
+    gab_recordof(gab, gab_number(0), gab_number(i));
+
+  gab_gcstats(gab, &after);
+
+  munit_assert_uint64(after.triggers[kGAB_GCTRIGGER_BUFFER], >,
+                      before.triggers[kGAB_GCTRIGGER_BUFFER]);
+
+  wait_for_collection(&after, before.collections);
+
+  munit_assert_uint64(after.collections, >, before.collections);
+
+  return MUNIT_OK;
+}
+
+static MunitResult test_stats(const MunitParameter params[], void *data) {
+  const uint64_t n = 1000;
+
+  struct gab_gcstats before, stats;
+  gab_gcstats(gab, &before);
+
+  for (uint64_t i = 0; i < n; i++)
+    gab_recordof(gab, gab_number(0), gab_number(i));
+
+  gab_gcstats(gab, &stats);
+
+  munit_assert_uint64(stats.allocations, >=, before.allocations + n);
+  munit_assert_uint64(stats.allocated_bytes, >, before.allocated_bytes);
+  munit_assert_int64(stats.objects[kGAB_RECORD], >=,
+                     before.objects[kGAB_RECORD] + (int64_t)n);
+
+  int64_t peak = stats.objects[kGAB_RECORD];
+
+  // Decrements are processed an epoch after they are queued, so the records
+  // only die a few collections later - gab_destroy waits for four as well.
+  for (int i = 0; i < 4; i++) {
+    uint64_t collections = stats.collections;
+
+    munit_assert_true(gab_sigcoll(gab));
+    wait_for_collection(&stats, collections);
+
+    munit_assert_uint64(stats.collections, >, collections);
+  }
+
+  munit_assert_uint64(stats.triggers[kGAB_GCTRIGGER_EXPLICIT], >,
+                      before.triggers[kGAB_GCTRIGGER_EXPLICIT]);
+  munit_assert_int64(stats.objects[kGAB_RECORD], <=, peak - (int64_t)n);
+
+  return MUNIT_OK;
+}
+
+static MunitTest gc_tests[] = {
+    {
+        "/young_budget",
+        test_young_budget,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {
+        "/stats",
+        test_stats,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {},
+};
+
+const MunitSuite gc_suite = {
+    "/gc", gc_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE,
+};
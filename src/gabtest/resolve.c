@@ -0,0 +1,127 @@
+#include <string.h>
+
+#include "cgab.h"
+#include "munit/munit.h"
+
+static uint64_t lookups;
+
+/*
+ * Only 'pkg/mod.gab' exists. Counting calls tells us when the resolution
+ * cache went to the (pretend) filesystem.
+ */
+static bool count_exister(const char *path) {
+  lookups++;
+  return !strcmp(path, "/virtual/pkg/mod.gab");
+}
+
+static const char *roots[] = {"/virtual/", nullptr};
+
+static const struct gab_resource resources[] = {
+    {"", ".gab", nullptr, count_exister},
+    {},
+};
+
+static void *setup(const MunitParameter params[], void *data) {
+  static struct gab_triple res_gab;
+
+  union gab_value_pair result = gab_create(
+      (struct gab_create_argt){
+          .jobs = 1,
+          .roots = roots,
+          .resources = resources,
+      },
+      &res_gab);
+
+  munit_assert_uint64(result.status, ==, gab_cvalid);
+
+  lookups = 0;
+  return &res_gab;
+}
+
+static void teardown(void *data) { gab_destroy(*(struct gab_triple *)data); }
+
+static MunitResult test_hit(const MunitParameter params[], void *data) {
+  struct gab_triple gab = *(struct gab_triple *)data;
+
+  struct gab_module_res first = gab_resolve(gab, "pkg", "mod");
+  munit_assert_ptr_equal(first.resource, resources);
+  munit_assert_string_equal(first.path, "/virtual/pkg/mod.gab");
+  munit_assert_uint64(lookups, ==, 1);
+
+  struct gab_module_res second = gab_resolve(gab, "pkg", "mod");
+  munit_assert_ptr_equal(second.path, first.path);
+  munit_assert_uint64(lookups, ==, 1);
+
+  return MUNIT_OK;
+}
+
+static MunitResult test_miss(const MunitParameter params[], void *data) {
+  struct gab_triple gab = *(struct gab_triple *)data;
+
+  struct gab_module_res first = gab_resolve(gab, "pkg", "missing");
+  munit_assert_null(first.resource);
+  munit_assert_null(first.path);
+
+  uint64_t after_first = lookups;
+  munit_assert_uint64(after_first, >, 0);
+
+  // Misses are cached too.
+  struct gab_module_res second = gab_resolve(gab, "pkg", "missing");
+  munit_assert_null(second.resource);
+  munit_assert_uint64(lookups, ==, after_first);
+
+  return MUNIT_OK;
+}
+
+static MunitResult test_reload(const MunitParameter params[], void *data) {
+  struct gab_triple gab = *(struct gab_triple *)data;
+
+  gab_resolve(gab, "pkg", "mod");
+  munit_assert_uint64(lookups, ==, 1);
+
+  struct gab_triple reload = gab;
+  reload.flags |= fGAB_USE_RELOAD;
+
+  struct gab_module_res reloaded = gab_resolve(reload, "pkg", "mod");
+  munit_assert_string_equal(reloaded.path, "/virtual/pkg/mod.gab");
+  munit_assert_uint64(lookups, ==, 2);
+
+  // The reloaded outcome replaces the cached one.
+  struct gab_module_res cached = gab_resolve(gab, "pkg", "mod");
+  munit_assert_ptr_equal(cached.path, reloaded.path);
+  munit_assert_uint64(lookups, ==, 2);
+
+  return MUNIT_OK;
+}
+
+static MunitTest resolve_tests[] = {
+    {
+        "/hit",
+        test_hit,
+        setup,
+        teardown,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {
+        "/miss",
+        test_miss,
+        setup,
+        teardown,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {
+        "/reload",
+        test_reload,
+        setup,
+        teardown,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
+    {},
+};
+
+const MunitSuite resolve_suite = {
+    "/resolve", resolve_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE,
+};
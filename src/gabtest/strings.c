@@ -91,6 +91,67 @@ static MunitResult test_string_grapheme(const MunitParameter params[],
   return MUNIT_OK;
 }
 
+/*
+ * Strings past cGAB_STRING_INTERN_MAX aren't interned when they are created,
+ * so a big string and its interned twin are equal without being identical.
+ */
+static MunitResult test_string_big(const MunitParameter params[], void *data) {
+  char buf[cGAB_STRING_INTERN_MAX + 64];
+  memset(buf, 'g', sizeof(buf));
+  buf[sizeof(buf) - 1] = 'b';
+
+  gab_value big = gab_nstring(gab, sizeof(buf), buf);
+  gab_value twin = gab_strintern(gab, gab_nstring(gab, sizeof(buf), buf));
+
+  munit_assert_uint64(gab_valkind(big), ==, kGAB_STRING);
+  munit_assert_uint64(gab_valkind(twin), ==, kGAB_STRING);
+  munit_assert_uint64(big, !=, twin);
+  munit_assert_true(gab_valequal(big, twin));
+  munit_assert_uint64(gab_strintern(gab, big), ==, twin);
+
+  // Compared with '=='
+  union gab_value_pair eq = gab_exec(gab, (struct gab_exec_argt){
+                                              .source = "a == b",
+                                              .name = "test_string_big_eq",
+                                              .len = 2,
+                                              .sargv = (const char *[]){"a", "b"},
+                                              .argv = (gab_value[]){big, twin},
+                                          });
+
+  munit_assert_uint64(eq.status, ==, gab_cvalid);
+  munit_assert_uint64(eq.aresult[0], ==, gab_ok);
+  munit_assert_uint64(eq.aresult[1], ==, gab_true);
+
+  // As a record key
+  gab_value rec = gab_record(gab, 1, 1, &twin, (gab_value[]){gab_number(1)});
+  munit_assert_uint64(gab_recat(rec, big), ==, gab_number(1));
+
+  rec = gab_recput(gab, rec, big, gab_number(2));
+  munit_assert_uint64(gab_reclen(rec), ==, 1);
+  munit_assert_uint64(gab_recat(rec, twin), ==, gab_number(2));
+
+  // As a message
+  gab_value msg = gab_nmessage(gab, sizeof(buf), buf);
+  munit_assert_uint64(msg, ==, gab_strtomsg(twin));
+
+  gab_def(gab, {
+                   msg,
+                   gab_type(gab, kGAB_NUMBER),
+                   gab_number(3),
+               });
+
+  union gab_value_pair sent = gab_send(gab, (struct gab_send_argt){
+                                                .message = gab_strtomsg(big),
+                                                .receiver = gab_number(0),
+                                            });
+
+  munit_assert_uint64(sent.status, ==, gab_cvalid);
+  munit_assert_uint64(sent.aresult[0], ==, gab_ok);
+  munit_assert_uint64(sent.aresult[1], ==, gab_number(3));
+
+  return MUNIT_OK;
+}
+
 static MunitTest string_tests[] = {
     {
         "/creation",
@@ -124,6 +185,14 @@ static MunitTest string_tests[] = {
         MUNIT_TEST_OPTION_NONE,
         NULL,
     },
+    {
+        "/big",
+        test_string_big,
+        NULL,
+        NULL,
+        MUNIT_TEST_OPTION_NONE,
+        NULL,
+    },
     {
         NULL,
         NULL,
@@ -0,0 +1,135 @@
+/**
+ *  MIT License
+ *
+ *  Copyright (c) 2023-2026 Teddy Randby
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "cgab.h"
+
+static gab_value hist_list(struct gab_triple gab, uint64_t *hist) {
+  gab_value buckets[GAB_GCSTATS_NBUCKETS];
+
+  for (int i = 0; i < GAB_GCSTATS_NBUCKETS; i++)
+    buckets[i] = gab_number(hist[i]);
+
+  return gab_list(gab, 1, GAB_GCSTATS_NBUCKETS, buckets);
+}
+
+GAB_DYNLIB_NATIVE_FN(gc, stats) {
+  struct gab_gcstats stats;
+  gab_gcstats(gab, &stats);
+
+  gab_gclock(gab);
+
+  gab_value kinds[kGAB_NKINDS * 2];
+  for (int k = 0; k < kGAB_NKINDS; k++) {
+    kinds[k * 2] = gab_type(gab, k);
+    kinds[k * 2 + 1] =
+        gab_recordof(gab, gab_message(gab, "objects"),
+                     gab_number(stats.objects[k]), gab_message(gab, "bytes"),
+                     gab_number(stats.bytes[k]));
+  }
+
+  gab_value rec = gab_recordof(
+      gab, gab_message(gab, "collections"), gab_number(stats.collections),
+      gab_message(gab, "triggers"),
+      gab_recordof(gab, gab_message(gab, "explicit"),
+                   gab_number(stats.triggers[kGAB_GCTRIGGER_EXPLICIT]),
+                   gab_message(gab, "buffer"),
+                   gab_number(stats.triggers[kGAB_GCTRIGGER_BUFFER])),
+      gab_message(gab, "collect"),
+      gab_recordof(gab, gab_message(gab, "total\\ns"),
+                   gab_number(stats.collect_ns), gab_message(gab, "max\\ns"),
+                   gab_number(stats.collect_max_ns),
+                   gab_message(gab, "histogram"),
+                   hist_list(gab, stats.collect_hist)),
+      gab_message(gab, "pause"),
+      gab_recordof(gab, gab_message(gab, "total\\ns"),
+                   gab_number(stats.pause_ns), gab_message(gab, "max\\ns"),
+                   gab_number(stats.pause_max_ns),
+                   gab_message(gab, "histogram"),
+                   hist_list(gab, stats.pause_hist)),
+      gab_message(gab, "dead"), gab_number(stats.dead),
+      gab_message(gab, "overflow\\rc"), gab_number(stats.overflow_rc),
+      gab_message(gab, "kinds"),
+      gab_record(gab, 2, kGAB_NKINDS, kinds, kinds + 1));
+
+  gab_vmpush(gab_thisvm(gab), rec);
+
+  return gab_gcunlock(gab), gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(gc, jobs) {
+  struct gab_gcstats stats;
+  gab_gcstats(gab, &stats);
+
+  gab_gclock(gab);
+
+  gab_value jobs[stats.njobs];
+  for (uint64_t i = 0; i < stats.njobs; i++) {
+    struct gab_gcjobstats job;
+    gab_gcjobstats(gab, i, &job);
+
+    jobs[i] = gab_recordof(
+        gab, gab_message(gab, "stack"), gab_number(job.stack_hwm),
+        gab_message(gab, "inc"), gab_number(job.inc_hwm),
+        gab_message(gab, "dec"), gab_number(job.dec_hwm),
+        gab_message(gab, "young"), gab_number(job.young_hwm));
+  }
+
+  gab_vmpush(gab_thisvm(gab), gab_list(gab, 1, stats.njobs, jobs));
+
+  return gab_gcunlock(gab), gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(gc, collect) {
+  bool ok = gab_sigcoll(gab);
+
+  gab_vmpush(gab_thisvm(gab), gab_bool(ok));
+
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_MAIN_FN {
+  gab_value mod = gab_message(gab, "gab\\gc");
+
+  gab_def(gab,
+          {
+              gab_message(gab, "stats"),
+              mod,
+              gab_snative(gab, "stats", gab_mod_gc_stats),
+          },
+          {
+              gab_message(gab, "jobs"),
+              mod,
+              gab_snative(gab, "jobs", gab_mod_gc_jobs),
+          },
+          {
+              gab_message(gab, "collect"),
+              mod,
+              gab_snative(gab, "collect", gab_mod_gc_collect),
+          });
+
+  return (union gab_value_pair){
+      .status = gab_cvalid,
+      .aresult = gab_valarray(gab_ok, mod),
+  };
+}
@@ -1613,19 +1613,30 @@ GAB_DYNLIB_NATIVE_FN(io, send) {
 
   gab_value str = gab_arg(1);
 
-  if (gab_valkind(str) != kGAB_BINARY)
+  const char *data;
+  size_t len;
+
+  if (gab_valkind(str) == kGAB_BOX &&
+      gab_boxtype(str) == gab_string(gab, tGAB_STRBUILDER)) {
+    // Write a builder's buffer as it is, without making a binary of it.
+    // The builder stays alive on the fiber's stack for the whole send.
+    struct gab_strbuilder *b = gab_boxdata(str);
+    data = b->data;
+    len = b->len;
+  } else if (gab_valkind(str) == kGAB_BINARY) {
+    // Get the data from the str on the fibers stack.
+    // This is because gab_strdata may return a pointer *into*
+    // the string value itself (if the string is short enough).
+    // For this case, we need that pointer to be valid for the
+    // lifetime of this send (ie, the fibers stack)
+    data = gab_strdata(argv + 1);
+    len = gab_strlen(str);
+  } else {
     return gab_pktypemismatch(gab, str, kGAB_BINARY);
+  }
 
   struct gab_io *io = gab_boxdata(vsock);
 
-  // Get the data from the str on the fibers stack.
-  // This is because gab_strdata may return a pointer *into*
-  // the string value itself (if the string is short enough).
-  // For this case, we need that pointer to be valid for the
-  // lifetime of this send (ie, the fibers stack)
-  const char *data = gab_strdata(argv + 1);
-  size_t len = gab_strlen(str);
-
   union gab_value_pair res;
   mtx_lock(&io->mtx);
 
@@ -50,7 +50,8 @@ GAB_DYNLIB_NATIVE_FN(message, create) {
   if (gab_valkind(name) != kGAB_STRING)
     return gab_pktypemismatch(gab, name, kGAB_STRING);
 
-  gab_vmpush(gab_thisvm(gab), gab_strtomsg(name));
+  // Messages are compared by identity, so big strings must be interned first.
+  gab_vmpush(gab_thisvm(gab), gab_strtomsg(gab_strintern(gab, name)));
   return gab_union_cvalid(gab_nil);
 }
 
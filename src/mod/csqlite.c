@@ -47,22 +47,79 @@
  */
 
 #define cGAB_CSQLITE_TYPE "db\\row"
+#define cGAB_CSQLITE_CURSOR_TYPE "db\\cursor"
 
 #define cGAB_CSQLITE_MAXPATH 2048
 
+/*
+ * The number of prepared statements each connection keeps around.
+ *
+ * Statements are cached by their sql text, and the least recently used is
+ * finalized once there are more than this. Statements held by a cursor are
+ * never finalized - so more than this may be alive at once.
+ */
+#define cGAB_CSQLITE_STMTCACHE 32
+
+/*
+ * A cached statement is only ever stepped by the worker which owns its
+ * connection. A cursor borrows the statement (kSTMT_BUSY) for its lifetime.
+ *
+ * Cursors are destroyed by the garbage collector, on *its* thread - which
+ * cannot touch the statement. Instead, it marks the statement as abandoned,
+ * and the owning worker resets it the next time it looks in the cache.
+ *
+ * Until then, a cursor which was dropped before reaching its last row keeps
+ * its read transaction open. If that worker never uses the database again,
+ * this blocks WAL checkpoints for as long as the connection lives. A cursor
+ * which reaches its last row is reset immediately, and holds nothing.
+ */
+enum gab_sqlite_stmt_state {
+  kSTMT_IDLE,
+  kSTMT_BUSY,
+  kSTMT_ABANDONED,
+};
+
+struct gab_sqlite_stmt {
+  _Atomic enum gab_sqlite_stmt_state state;
+  uint64_t used;
+  uint64_t len;
+  char *sql;
+  sqlite3_stmt *stmt;
+};
+
+#define T struct gab_sqlite_stmt *
+#define NAME gab_sqlite_stmt
+#include "vector.h"
+
+/*
+ * The connection (and its statements) belonging to one worker.
+ */
+struct gab_sqlite_db {
+  sqlite3 *db;
+  int status;
+  uint64_t tick;
+  v_gab_sqlite_stmt stmts;
+};
+
 struct gab_sqlite_conn {
   char path[cGAB_CSQLITE_MAXPATH];
   int len;
-  sqlite3 *connections[];
+  struct gab_sqlite_db *dbs[];
+};
+
+struct gab_sqlite_cursor {
+  struct gab_sqlite_db *db;
+  struct gab_sqlite_stmt *stmt;
+  int wkid;
 };
 
 gab_value make_conn(struct gab_triple gab, const char *path) {
-  gab_value conn =
-      gab_box(gab, (struct gab_box_argt){
-                       .size = sizeof(struct gab_sqlite_conn) +
-                               gab_eglen(gab.eg) * sizeof(sqlite3 *),
-                       .type = gab_string(gab, cGAB_CSQLITE_TYPE),
-                   });
+  gab_value conn = gab_box(
+      gab, (struct gab_box_argt){
+               .size = sizeof(struct gab_sqlite_conn) +
+                       gab_eglen(gab.eg) * sizeof(struct gab_sqlite_db *),
+               .type = gab_string(gab, cGAB_CSQLITE_TYPE),
+           });
 
   struct gab_sqlite_conn *sql = gab_boxdata(conn);
 
@@ -72,18 +129,266 @@ gab_value make_conn(struct gab_triple gab, const char *path) {
   return conn;
 }
 
-int get_conn(struct gab_triple gab, gab_value conn, sqlite3 **out_conn) {
+int get_conn(struct gab_triple gab, gab_value conn,
+             struct gab_sqlite_db **out_db) {
   struct gab_sqlite_conn *sql = gab_boxdata(conn);
-  sqlite3 *sql_conn = sql->connections[gab.wkid];
+  struct gab_sqlite_db *db = sql->dbs[gab.wkid];
+
+  if (db != nullptr)
+    return *out_db = db, db->status;
+
+  db = malloc(sizeof(struct gab_sqlite_db));
+  gab_assert(db != nullptr, "Assume malloc can't fail");
+
+  db->tick = 0;
+  v_gab_sqlite_stmt_create(&db->stmts, 8);
+
+  // Even if this fails, the handle is kept so that the error can be reported.
+  db->status = sqlite3_open_v2(sql->path, &db->db,
+                               SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                               nullptr);
+
+  sql->dbs[gab.wkid] = db;
+
+  return *out_db = db, db->status;
+}
+
+void stmt_release(struct gab_sqlite_stmt *s) {
+  sqlite3_reset(s->stmt);
+  sqlite3_clear_bindings(s->stmt);
+  atomic_store(&s->state, kSTMT_IDLE);
+}
+
+/*
+ * Finalize the least recently used statements which aren't in use, until we
+ * are back within the cache's size.
+ */
+void stmt_trim(struct gab_sqlite_db *db) {
+  while (db->stmts.len > cGAB_CSQLITE_STMTCACHE) {
+    uint64_t lru = db->stmts.len;
+
+    for (uint64_t i = 0; i < db->stmts.len; i++) {
+      struct gab_sqlite_stmt *s = v_gab_sqlite_stmt_val_at(&db->stmts, i);
+
+      if (atomic_load(&s->state) != kSTMT_IDLE)
+        continue;
+
+      if (lru == db->stmts.len ||
+          s->used < v_gab_sqlite_stmt_val_at(&db->stmts, lru)->used)
+        lru = i;
+    }
+
+    if (lru == db->stmts.len)
+      return;
+
+    struct gab_sqlite_stmt *s = v_gab_sqlite_stmt_val_at(&db->stmts, lru);
+    db->stmts.data[lru] = v_gab_sqlite_stmt_pop(&db->stmts);
+
+    sqlite3_finalize(s->stmt);
+    free(s->sql);
+    free(s);
+  }
+}
+
+/*
+ * Borrow a prepared statement for 'sql' from the cache, preparing one if
+ * there isn't an idle one already.
+ *
+ * The statement is returned with kSTMT_BUSY, and must be given back with
+ * stmt_release.
+ */
+struct gab_sqlite_stmt *stmt_acquire(struct gab_sqlite_db *db, const char *sql,
+                                     uint64_t len, int *res) {
+  struct gab_sqlite_stmt *found = nullptr;
+
+  db->tick++;
+
+  for (uint64_t i = 0; i < db->stmts.len; i++) {
+    struct gab_sqlite_stmt *s = v_gab_sqlite_stmt_val_at(&db->stmts, i);
+
+    enum gab_sqlite_stmt_state state = atomic_load(&s->state);
+
+    if (state == kSTMT_ABANDONED)
+      stmt_release(s), state = kSTMT_IDLE;
+
+    if (found || state != kSTMT_IDLE)
+      continue;
+
+    if (s->len == len && !memcmp(s->sql, sql, len))
+      found = s;
+  }
+
+  if (found) {
+    atomic_store(&found->state, kSTMT_BUSY);
+    found->used = db->tick;
+    return *res = SQLITE_OK, found;
+  }
+
+  sqlite3_stmt *stmt = nullptr;
+  *res = sqlite3_prepare_v3(db->db, sql, len, SQLITE_PREPARE_PERSISTENT, &stmt,
+                            nullptr);
+
+  if (*res != SQLITE_OK)
+    return nullptr;
+
+  found = malloc(sizeof(struct gab_sqlite_stmt));
+  gab_assert(found != nullptr, "Assume malloc can't fail");
+
+  found->sql = malloc(len);
+  gab_assert(found->sql != nullptr, "Assume malloc can't fail");
+  memcpy(found->sql, sql, len);
+
+  found->len = len;
+  found->stmt = stmt;
+  found->used = db->tick;
+  atomic_init(&found->state, kSTMT_BUSY);
+
+  v_gab_sqlite_stmt_push(&db->stmts, found);
+  stmt_trim(db);
+
+  return found;
+}
+
+/*
+ * Bind a single value to the parameter at idx, returning an error message if
+ * it can't be bound.
+ *
+ * If the value is 'pinned' - guaranteed to be reachable until the statement's
+ * bindings are cleared - sqlite can borrow string data rather than copy it.
+ * Short strings live inside the gab_value itself, so those are always copied.
+ */
+const char *bind_value(sqlite3_stmt *stmts, int idx, gab_value value,
+                       bool pinned) {
+  void (*lifetime)(void *) =
+      pinned && gab_valiso(value) ? SQLITE_STATIC : SQLITE_TRANSIENT;
+
+  switch (gab_valkind(value)) {
+  case kGAB_NUMBER: {
+    double d = gab_valtof(value);
+
+    // Integral numbers bind as integers, so that they are stored as such.
+    if (d >= -0x1p63 && d < 0x1p63 && d == (double)(int64_t)d) {
+      if (sqlite3_bind_int64(stmts, idx, (int64_t)d) != SQLITE_OK)
+        return "Could not bind number parameter";
+      break;
+    }
+
+    if (sqlite3_bind_double(stmts, idx, d) != SQLITE_OK)
+      return "Could not bind number parameter";
+    break;
+  }
+  case kGAB_STRING: {
+    if (sqlite3_bind_text(stmts, idx, gab_strdata(&value), gab_strlen(value),
+                          lifetime) != SQLITE_OK)
+      return "Could not bind string parameter";
+    break;
+  }
+  case kGAB_BINARY: {
+    if (sqlite3_bind_blob(stmts, idx, gab_strdata(&value), gab_strlen(value),
+                          lifetime) != SQLITE_OK)
+      return "Could not bind binary parameter";
+    break;
+  }
+  case kGAB_MESSAGE: {
+    if (value == gab_nil) {
+      if (sqlite3_bind_null(stmts, idx) != SQLITE_OK)
+        return "Could not bind nil parameter";
+      break;
+    }
+
+    // Sqlite has no boolean type - it stores them as the integers 0 and 1.
+    if (gab_valisb(value)) {
+      if (sqlite3_bind_int(stmts, idx, value == gab_true) != SQLITE_OK)
+        return "Could not bind boolean parameter";
+      break;
+    }
+
+    return "Could not bind message parameter";
+  }
+  default:
+    return "Cannot bind parameter of this type";
+  }
+
+  return nullptr;
+}
+
+/*
+ * Bind the named parameters in args, which alternate between name and value.
+ *
+ * If a parameter can't be bound, the result holds the error message.
+ */
+union gab_value_pair stmt_bind(struct gab_triple gab, sqlite3_stmt *stmts,
+                               uint64_t len, gab_value *args, bool pinned) {
+  for (uint64_t i = 0; i + 1 < len; i += 2) {
+    gab_value sname = args[i];
+    gab_value value = args[i + 1];
+
+    if (gab_valkind(sname) != kGAB_STRING)
+      return gab_pktypemismatch(gab, sname, kGAB_STRING);
+
+    const char *cname = gab_strdata(&sname);
+    int idx = sqlite3_bind_parameter_index(stmts, cname);
+
+    if (!idx)
+      return gab_union_cvalid(gab_string(gab, "Invalid parameter name"));
+
+    const char *err = bind_value(stmts, idx, value, pinned);
+
+    if (err)
+      return gab_union_cvalid(gab_string(gab, err));
+  }
+
+  return gab_union_cvalid(gab_nil);
+}
+
+/*
+ * Find the parameter for the key of a record being bound.
+ *
+ * Lists bind by position. Strings name the parameter exactly, and messages
+ * name it without its prefix - so 'id:' finds ':id', '@id' or '$id'.
+ */
+int param_index(sqlite3_stmt *stmts, gab_value key, uint64_t pos, bool list) {
+  if (list)
+    return pos < sqlite3_bind_parameter_count(stmts) ? pos + 1 : 0;
 
-  if (sql_conn != nullptr)
-    return *out_conn = sql_conn, SQLITE_OK;
+  if (gab_valkind(key) == kGAB_STRING)
+    return sqlite3_bind_parameter_index(stmts, gab_strdata(&key));
 
-  int res =
-      sqlite3_open_v2(sql->path, sql->connections + gab.wkid,
-                      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+  if (gab_valkind(key) != kGAB_MESSAGE)
+    return 0;
 
-  return *out_conn = sql_conn, res;
+  gab_value str = gab_msgtostr(key);
+  uint64_t len = gab_strlen(str);
+
+  char name[len + 2];
+  memcpy(name + 1, gab_strdata(&str), len);
+  name[len + 1] = '\0';
+
+  for (const char *prefix = ":@$"; *prefix; prefix++) {
+    name[0] = *prefix;
+
+    int idx = sqlite3_bind_parameter_index(stmts, name);
+    if (idx)
+      return idx;
+  }
+
+  return 0;
+}
+
+gab_value column_value(struct gab_triple gab, sqlite3_stmt *stmts, int i) {
+  sqlite3_value *v = sqlite3_column_value(stmts, i);
+
+  switch (sqlite3_column_type(stmts, i)) {
+  case SQLITE_INTEGER:
+  case SQLITE_FLOAT:
+    return gab_number(sqlite3_value_double(v));
+  case SQLITE_TEXT:
+    return gab_string(gab, (const char *)sqlite3_value_text(v));
+  case SQLITE_BLOB:
+    return gab_nbinary(gab, sqlite3_value_bytes(v), sqlite3_value_blob(v));
+  default:
+    return gab_nil;
+  }
 }
 
 GAB_DYNLIB_NATIVE_FN(row, open) {
@@ -103,12 +408,12 @@ GAB_DYNLIB_NATIVE_FN(row, open) {
 
   // Test the connection by eagerly spawning one
   // for the current worker.
-  sqlite3 *sqlite;
-  int res = get_conn(gab, conn, &sqlite);
+  struct gab_sqlite_db *db;
+  int res = get_conn(gab, conn, &db);
 
   // This can fail.
   if (res != SQLITE_OK)
-    return gab_push(gab, gab_err, gab_string(gab, sqlite3_errmsg(sqlite))),
+    return gab_push(gab, gab_err, gab_string(gab, sqlite3_errmsg(db->db))),
            gab_union_cvalid(gab_nil);
 
   return gab_push(gab, gab_ok, conn), gab_union_cvalid(gab_nil);
@@ -117,101 +422,49 @@ GAB_DYNLIB_NATIVE_FN(row, open) {
 GAB_DYNLIB_NATIVE_FN(row, exec) {
   gab_value conn = gab_arg(0);
 
-  sqlite3 *sqlite;
-  int res = get_conn(gab, conn, &sqlite);
+  struct gab_sqlite_db *db;
+  int res = get_conn(gab, conn, &db);
 
   if (res != SQLITE_OK)
-    return gab_panicf(gab, "$", gab_string(gab, sqlite3_errmsg(sqlite)));
+    return gab_panicf(gab, "$", gab_string(gab, sqlite3_errmsg(db->db)));
 
   gab_value stmt = gab_arg(1);
 
   if (gab_valkind(stmt) != kGAB_STRING)
     return gab_pktypemismatch(gab, stmt, kGAB_STRING);
 
-  const char *sql = gab_strdata(&stmt);
-
-  sqlite3_stmt *stmts = nullptr;
-  res = sqlite3_prepare_v2(sqlite, sql, gab_strlen(stmt), &stmts, nullptr);
+  struct gab_sqlite_stmt *cached =
+      stmt_acquire(db, gab_strdata(&stmt), gab_strlen(stmt), &res);
 
-  if (res != SQLITE_OK)
+  if (cached == nullptr)
     return gab_vmpush(gab_thisvm(gab), gab_err,
-                      gab_string(gab, sqlite3_errmsg(sqlite))),
+                      gab_string(gab, sqlite3_errmsg(db->db))),
            gab_union_cvalid(gab_nil);
+
+  sqlite3_stmt *stmts = cached->stmt;
+
   /*
    * Bind parameters
    *
    * 0 and 1 are conn and query.
    */
-  for (uint64_t i = 2; i < argc; i += 2) {
-    gab_value sname = gab_arg(i);
-    gab_value value = gab_arg(i + 1);
-
-    if (gab_valkind(sname) != kGAB_STRING)
-      return gab_pktypemismatch(gab, sname, kGAB_STRING);
-
-    const char *cname = gab_strdata(&sname);
-    int idx = sqlite3_bind_parameter_index(stmts, cname);
-
-    if (!idx)
-      return gab_vmpush(gab_thisvm(gab), gab_err,
-                        gab_string(gab, "Invalid parameter name")),
+  if (argc > 2) {
+    // Our arguments stay on the stack until we return, and the bindings are
+    // cleared before then - so sqlite needn't copy them.
+    union gab_value_pair bound =
+        stmt_bind(gab, stmts, argc - 2, argv + 2, true);
+
+    if (bound.status != gab_cundefined)
+      return stmt_release(cached), bound;
+
+    if (bound.vresult != gab_nil)
+      return stmt_release(cached),
+             gab_vmpush(gab_thisvm(gab), gab_err, bound.vresult),
              gab_union_cvalid(gab_nil);
-
-    switch (gab_valkind(value)) {
-    case kGAB_NUMBER: {
-      if (sqlite3_bind_double(stmts, idx, gab_valtof(value)) != SQLITE_OK)
-        return gab_vmpush(gab_thisvm(gab), gab_err,
-                          gab_string(gab, "Could not bind number parameter")),
-               gab_union_cvalid(gab_nil);
-      break;
-    }
-      // TODO @csqlite @qol: Better string lifetimes.
-      // SQLITE_TRANSIENT Tells sql it should handle the lifetime of the string
-      // data. This might not be necessary - we could probably make some
-      // guarantees for sqlite about this. Might save time copying big strings.
-    case kGAB_STRING: {
-      if (sqlite3_bind_text(stmts, idx, gab_strdata(&value), gab_strlen(value),
-                            SQLITE_TRANSIENT) != SQLITE_OK)
-        return gab_vmpush(gab_thisvm(gab), gab_err,
-                          gab_string(gab, "Could not bind string parameter")),
-               gab_union_cvalid(gab_nil);
-      break;
-    }
-    case kGAB_BINARY: {
-      if (sqlite3_bind_blob(stmts, idx, gab_strdata(&value), gab_strlen(value),
-                            SQLITE_TRANSIENT) != SQLITE_OK)
-        return gab_vmpush(gab_thisvm(gab), gab_err,
-                          gab_string(gab, "Could not bind binary parameter")),
-               gab_union_cvalid(gab_nil);
-      break;
-    }
-    case kGAB_MESSAGE: {
-      if (value == gab_nil) {
-        if (sqlite3_bind_null(stmts, idx) != SQLITE_OK)
-          return gab_vmpush(gab_thisvm(gab), gab_err,
-                            gab_string(gab, "Could not bind nil parameter")),
-                 gab_union_cvalid(gab_nil);
-
-        break;
-      }
-
-      // TODO @csqlite @feat: Add true and false here?
-      // Should they just bind to ints?
-
-      return gab_vmpush(gab_thisvm(gab), gab_err,
-                        gab_string(gab, "Could not bind message parameter")),
-             gab_union_cvalid(gab_nil);
-    }
-    default:
-      return gab_vmpush(gab_thisvm(gab), gab_err,
-                        gab_string(gab, "Cannot bind parameter of this type")),
-             gab_union_cvalid(gab_nil);
-    }
   }
 
-  // TODO @bug: Locking the GC while performing the step isn't idea.
-  // In general, it might be better to allow the *user* to lazyily step
-  // statement. We could simply implement seq\init and seq\next.
+  // TODO @bug: Locking the GC while performing the step isn't ideal.
+  // Prefer 'query', which steps lazily as its cursor is consumed.
   gab_gclock(gab);
 
   while ((res = sqlite3_step(stmts)) != SQLITE_DONE) {
@@ -221,40 +474,23 @@ GAB_DYNLIB_NATIVE_FN(row, exec) {
       int cols = sqlite3_column_count(stmts);
       // cols may be 0, if there is no data returned.
 
-      for (int i = 0; i < cols; i++) {
-        sqlite3_value *v = sqlite3_column_value(stmts, i);
-
-        switch (sqlite3_column_type(stmts, i)) {
-        case SQLITE_INTEGER:
-        case SQLITE_FLOAT:
-          gab_wfibpush(gab_thisfiber(gab), gab_number(sqlite3_value_double(v)));
-          break;
-        case SQLITE_TEXT:
-          gab_wfibpush(gab_thisfiber(gab),
-                       gab_string(gab, (const char *)sqlite3_value_text(v)));
-          break;
-        case SQLITE_BLOB:
-          gab_wfibpush(
-              gab_thisfiber(gab),
-              gab_nbinary(gab, sqlite3_value_bytes(v), sqlite3_value_blob(v)));
-          break;
-        case SQLITE_NULL:
-          gab_wfibpush(gab_thisfiber(gab), gab_nil);
-          break;
-        }
-      }
+      for (int i = 0; i < cols; i++)
+        gab_wfibpush(gab_thisfiber(gab), column_value(gab, stmts, i));
+
       break;
     case SQLITE_DONE:
       break;
     default:
       return gab_gcunlock(gab),
              gab_vmpush(gab_thisvm(gab), gab_err,
-                        gab_string(gab, sqlite3_errmsg(sqlite))),
-             gab_union_cvalid(gab_nil);
+                        gab_string(gab, sqlite3_errmsg(db->db))),
+             stmt_release(cached), gab_union_cvalid(gab_nil);
     }
   }
   gab_gcunlock(gab);
 
+  stmt_release(cached);
+
   // Push everything we allocated on the temp buffer.
   gab_vmpush(gab_thisvm(gab), gab_ok);
 
@@ -267,9 +503,311 @@ GAB_DYNLIB_NATIVE_FN(row, exec) {
   return gab_union_cvalid(gab_nil);
 }
 
+/*
+ * Run a statement once for each record of parameters in a list, inside a
+ * single transaction. If we're already inside a transaction, it is left to
+ * whoever began it.
+ *
+ * The statement is prepared once, and the parameter for each key is only
+ * looked up again when a record's shape differs from the last one.
+ */
+GAB_DYNLIB_NATIVE_FN(row, exec_many) {
+  gab_value conn = gab_arg(0);
+
+  struct gab_sqlite_db *db;
+  int res = get_conn(gab, conn, &db);
+
+  if (res != SQLITE_OK)
+    return gab_panicf(gab, "$", gab_string(gab, sqlite3_errmsg(db->db)));
+
+  gab_value stmt = gab_arg(1);
+  gab_value rows = gab_arg(2);
+
+  if (gab_valkind(stmt) != kGAB_STRING)
+    return gab_pktypemismatch(gab, stmt, kGAB_STRING);
+
+  if (gab_valkind(rows) != kGAB_RECORD)
+    return gab_pktypemismatch(gab, rows, kGAB_RECORD);
+
+  struct gab_sqlite_stmt *cached =
+      stmt_acquire(db, gab_strdata(&stmt), gab_strlen(stmt), &res);
+
+  if (cached == nullptr)
+    return gab_vmpush(gab_thisvm(gab), gab_err,
+                      gab_string(gab, sqlite3_errmsg(db->db))),
+           gab_union_cvalid(gab_nil);
+
+  sqlite3_stmt *stmts = cached->stmt;
+
+  bool owns_txn = sqlite3_get_autocommit(db->db);
+
+  if (owns_txn && sqlite3_exec(db->db, "BEGIN", nullptr, nullptr, nullptr) !=
+                      SQLITE_OK)
+    return stmt_release(cached),
+           gab_vmpush(gab_thisvm(gab), gab_err,
+                      gab_string(gab, sqlite3_errmsg(db->db))),
+           gab_union_cvalid(gab_nil);
+
+  union gab_value_pair result = gab_union_cvalid(gab_nil);
+  const char *err = nullptr;
+
+  gab_value shape = gab_cundefined;
+  int *idxs = nullptr;
+  uint64_t changes = 0;
+
+  uint64_t len = gab_reclen(rows);
+  for (uint64_t i = 0; i < len; i++) {
+    gab_value params = gab_uvrecat(rows, i);
+
+    if (gab_valkind(params) != kGAB_RECORD) {
+      result = gab_pktypemismatch(gab, params, kGAB_RECORD);
+      goto fail;
+    }
+
+    uint64_t nparams = gab_reclen(params);
+
+    if (gab_recshp(params) != shape) {
+      shape = gab_recshp(params);
+
+      idxs = realloc(idxs, (nparams ? nparams : 1) * sizeof(int));
+      gab_assert(idxs != nullptr, "Assume realloc can't fail");
+
+      bool list = gab_recisl(params);
+      for (uint64_t j = 0; j < nparams; j++) {
+        idxs[j] = param_index(stmts, gab_ukrecat(params, j), j, list);
+
+        if (!idxs[j]) {
+          err = "Invalid parameter name";
+          goto fail;
+        }
+      }
+
+      // Don't let bindings from a differently-shaped record linger.
+      sqlite3_clear_bindings(stmts);
+    }
+
+    // The list of records is on our stack until we return - so sqlite can
+    // borrow the data of the values we bind.
+    for (uint64_t j = 0; j < nparams; j++)
+      if ((err = bind_value(stmts, idxs[j], gab_uvrecat(params, j), true)))
+        goto fail;
+
+    while ((res = sqlite3_step(stmts)) == SQLITE_ROW)
+      ;
+
+    if (res != SQLITE_DONE) {
+      err = sqlite3_errmsg(db->db);
+      goto fail;
+    }
+
+    changes += sqlite3_changes64(db->db);
+    sqlite3_reset(stmts);
+  }
+
+  if (owns_txn && sqlite3_exec(db->db, "COMMIT", nullptr, nullptr, nullptr) !=
+                      SQLITE_OK) {
+    err = sqlite3_errmsg(db->db);
+    goto fail;
+  }
+
+  free(idxs);
+  stmt_release(cached);
+
+  gab_vmpush(gab_thisvm(gab), gab_ok, gab_number(changes));
+  return gab_union_cvalid(gab_nil);
+
+fail:
+  // Push the message before rolling back, which may overwrite it.
+  if (err)
+    gab_vmpush(gab_thisvm(gab), gab_err, gab_string(gab, err));
+
+  if (owns_txn)
+    sqlite3_exec(db->db, "ROLLBACK", nullptr, nullptr, nullptr);
+
+  free(idxs);
+  stmt_release(cached);
+
+  return result;
+}
+
+void cursor_destroy(struct gab_triple gab, uint64_t len, char *data) {
+  struct gab_sqlite_cursor *cur = (struct gab_sqlite_cursor *)data;
+
+  // We're on the gc's thread - leave the statement for its worker to reset.
+  if (cur->stmt)
+    atomic_store(&cur->stmt->state, kSTMT_ABANDONED);
+}
+
+GAB_DYNLIB_NATIVE_FN(row, query) {
+  gab_value conn = gab_arg(0);
+
+  struct gab_sqlite_db *db;
+  int res = get_conn(gab, conn, &db);
+
+  if (res != SQLITE_OK)
+    return gab_panicf(gab, "$", gab_string(gab, sqlite3_errmsg(db->db)));
+
+  gab_value stmt = gab_arg(1);
+
+  if (gab_valkind(stmt) != kGAB_STRING)
+    return gab_pktypemismatch(gab, stmt, kGAB_STRING);
+
+  struct gab_sqlite_stmt *cached =
+      stmt_acquire(db, gab_strdata(&stmt), gab_strlen(stmt), &res);
+
+  if (cached == nullptr)
+    return gab_vmpush(gab_thisvm(gab), gab_err,
+                      gab_string(gab, sqlite3_errmsg(db->db))),
+           gab_union_cvalid(gab_nil);
+
+  if (argc > 2) {
+    // The cursor outlives this call, so sqlite has to copy what we bind.
+    union gab_value_pair bound =
+        stmt_bind(gab, cached->stmt, argc - 2, argv + 2, false);
+
+    if (bound.status != gab_cundefined)
+      return stmt_release(cached), bound;
+
+    if (bound.vresult != gab_nil)
+      return stmt_release(cached),
+             gab_vmpush(gab_thisvm(gab), gab_err, bound.vresult),
+             gab_union_cvalid(gab_nil);
+  }
+
+  gab_value cursor =
+      gab_box(gab, (struct gab_box_argt){
+                       .size = sizeof(struct gab_sqlite_cursor),
+                       .type = gab_string(gab, cGAB_CSQLITE_CURSOR_TYPE),
+                       .destructor = cursor_destroy,
+                   });
+
+  struct gab_sqlite_cursor *cur = gab_boxdata(cursor);
+  cur->db = db;
+  cur->stmt = cached;
+  cur->wkid = gab.wkid;
+
+  return gab_push(gab, gab_ok, cursor), gab_union_cvalid(gab_nil);
+}
+
+/*
+ * The first column name which is shared with an earlier column, if any.
+ *
+ * Rows are records keyed by column name, so a join like
+ * "SELECT a.id, b.id ..." can't be represented without renaming one of them.
+ */
+const char *duplicate_column(sqlite3_stmt *stmts, int cols) {
+  for (int i = 1; i < cols; i++)
+    for (int j = 0; j < i; j++)
+      if (!strcmp(sqlite3_column_name(stmts, i), sqlite3_column_name(stmts, j)))
+        return sqlite3_column_name(stmts, i);
+
+  return nullptr;
+}
+
+/*
+ * Step the cursor once, pushing the next row as a record of 'shape'.
+ *
+ * The row is only materialized once sqlite has stepped - the gc is locked
+ * just long enough to build it, not for the whole query.
+ */
+union gab_value_pair cursor_step(struct gab_triple gab,
+                                 struct gab_sqlite_cursor *cur,
+                                 gab_value shape) {
+  sqlite3_stmt *stmts = cur->stmt->stmt;
+
+  int res = sqlite3_step(stmts);
+
+  if (res == SQLITE_DONE) {
+    // Keep our bindings, so that the cursor can be run again.
+    sqlite3_reset(stmts);
+    gab_vmpush(gab_thisvm(gab), gab_none);
+    return gab_union_cvalid(gab_nil);
+  }
+
+  if (res != SQLITE_ROW) {
+    sqlite3_reset(stmts);
+    return gab_panicf(gab, "$", gab_string(gab, sqlite3_errmsg(cur->db->db)));
+  }
+
+  int cols = sqlite3_column_count(stmts);
+  gab_value vals[cols];
+
+  const char *dup =
+      shape == gab_cundefined ? duplicate_column(stmts, cols) : nullptr;
+
+  if (dup) {
+    sqlite3_reset(stmts);
+    return gab_panicf(gab,
+                      "Column '$' appears more than once, rename it with AS",
+                      gab_string(gab, dup));
+  }
+
+  gab_gclock(gab);
+
+  // The first row builds the shape, which is then passed along as the key.
+  if (shape == gab_cundefined) {
+    gab_value keys[cols];
+
+    for (int i = 0; i < cols; i++)
+      keys[i] = gab_message(gab, sqlite3_column_name(stmts, i));
+
+    shape = gab_shape(gab, 1, cols, keys);
+  }
+
+  for (int i = 0; i < cols; i++)
+    vals[i] = column_value(gab, stmts, i);
+
+  gab_value row = gab_recordfrom(gab, shape, 1, cols, vals);
+
+  gab_gcunlock(gab);
+
+  gab_vmpush(gab_thisvm(gab), gab_ok, shape, row);
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(cursor, seq_init) {
+  gab_value cursor = gab_arg(0);
+
+  if (gab_valtype(gab, cursor) != gab_string(gab, cGAB_CSQLITE_CURSOR_TYPE))
+    return gab_ptypemismatch(gab, cursor,
+                             gab_string(gab, cGAB_CSQLITE_CURSOR_TYPE));
+
+  struct gab_sqlite_cursor *cur = gab_boxdata(cursor);
+
+  if (cur->wkid != gab.wkid)
+    return gab_panicf(gab, "A cursor can only be used on the thread it was "
+                           "created on");
+
+  // Begin again from the first row.
+  sqlite3_reset(cur->stmt->stmt);
+
+  return cursor_step(gab, cur, gab_cundefined);
+}
+
+GAB_DYNLIB_NATIVE_FN(cursor, seq_next) {
+  gab_value cursor = gab_arg(0);
+  gab_value shape = gab_arg(1);
+
+  if (gab_valtype(gab, cursor) != gab_string(gab, cGAB_CSQLITE_CURSOR_TYPE))
+    return gab_ptypemismatch(gab, cursor,
+                             gab_string(gab, cGAB_CSQLITE_CURSOR_TYPE));
+
+  if (gab_valkind(shape) != kGAB_SHAPE)
+    return gab_pktypemismatch(gab, shape, kGAB_SHAPE);
+
+  struct gab_sqlite_cursor *cur = gab_boxdata(cursor);
+
+  if (cur->wkid != gab.wkid)
+    return gab_panicf(gab, "A cursor can only be used on the thread it was "
+                           "created on");
+
+  return cursor_step(gab, cur, shape);
+}
+
 GAB_DYNLIB_MAIN_FN {
   gab_value mod = gab_message(gab, "sqlite");
   gab_value type = gab_string(gab, cGAB_CSQLITE_TYPE);
+  gab_value cursor_t = gab_string(gab, cGAB_CSQLITE_CURSOR_TYPE);
 
   gab_def(gab,
           {
@@ -281,6 +819,26 @@ GAB_DYNLIB_MAIN_FN {
               gab_message(gab, "eval"),
               type,
               gab_snative(gab, "eval", gab_mod_row_exec),
+          },
+          {
+              gab_message(gab, "exec\\many"),
+              type,
+              gab_snative(gab, "exec\\many", gab_mod_row_exec_many),
+          },
+          {
+              gab_message(gab, "query"),
+              type,
+              gab_snative(gab, "query", gab_mod_row_query),
+          },
+          {
+              gab_message(gab, "seq\\init"),
+              cursor_t,
+              gab_snative(gab, "seq\\init", gab_mod_cursor_seq_init),
+          },
+          {
+              gab_message(gab, "seq\\next"),
+              cursor_t,
+              gab_snative(gab, "seq\\next", gab_mod_cursor_seq_next),
           }, );
 
   return (union gab_value_pair){
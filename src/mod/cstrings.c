@@ -25,6 +25,7 @@
 #include "cgab.h"
 #include "libgrapheme/grapheme.h"
 #include <ctype.h>
+#include <string.h>
 
 #define T char
 #include "slice.h"
@@ -37,6 +38,18 @@ static inline bool instr(char c, const char *set) {
   return false;
 }
 
+/*
+ * The number of bytes in the grapheme at the start of data.
+ *
+ * In an ascii string each byte is a grapheme, except for "\r\n".
+ */
+static inline size_t next_grapheme(bool ascii, const char *data) {
+  if (ascii && *data != '\r')
+    return 1;
+
+  return grapheme_next_character_break_utf8(data, SIZE_MAX);
+}
+
 GAB_DYNLIB_NATIVE_FN(string, seq_init) {
   gab_value str = gab_arg(0);
 
@@ -52,7 +65,7 @@ GAB_DYNLIB_NATIVE_FN(string, seq_init) {
 
   const char *data = gab_strdata(&str);
 
-  size_t end = grapheme_next_character_break_utf8(data, SIZE_MAX);
+  size_t end = next_grapheme(gab_strisascii(str), data);
 
   gab_value grapheme = gab_nstring(gab, end, data);
   gab_vmpush(gab_thisvm(gab), gab_ok, 0, grapheme, 0);
@@ -83,15 +96,16 @@ GAB_DYNLIB_NATIVE_FN(string, seq_next) {
   assert(old_off < len);
   data += old_off;
 
-  size_t old_bytes = grapheme_next_character_break_utf8(data, SIZE_MAX);
+  bool ascii = gab_strisascii(str);
+
+  size_t old_bytes = next_grapheme(ascii, data);
 
   if (len <= old_off + old_bytes) {
     gab_vmpush(gab_thisvm(gab), gab_none);
     return gab_union_cvalid(gab_nil);
   }
 
-  size_t new_bytes =
-      grapheme_next_character_break_utf8(data + old_bytes, SIZE_MAX);
+  size_t new_bytes = next_grapheme(ascii, data + old_bytes);
 
   gab_value new_off = gab_number(old_off + old_bytes);
 
@@ -179,6 +193,57 @@ GAB_DYNLIB_NATIVE_FN(string, split) {
   return gab_union_cvalid(gab_nil);
 }
 
+/*
+ * Split the receiver on a separator, starting from a byte offset.
+ *
+ * Returns the offset just past the separator, and the piece before it.
+ * Unlike split, the rest of the string isn't copied - so walking a string
+ * piece by piece (see Strings.to\stream\split) is linear.
+ */
+GAB_DYNLIB_NATIVE_FN(string, split_next) {
+  gab_value str = gab_arg(0);
+  gab_value sep = gab_arg(1);
+  gab_value voff = gab_arg(2);
+
+  if (gab_valkind(sep) != kGAB_STRING)
+    return gab_pktypemismatch(gab, sep, kGAB_STRING);
+
+  if (gab_valkind(voff) != kGAB_NUMBER)
+    return gab_pktypemismatch(gab, voff, kGAB_NUMBER);
+
+  uint64_t cstr_len = gab_strlen(str);
+  uint64_t csep_len = gab_strlen(sep);
+  uint64_t begin = gab_valtou(voff);
+
+  if (begin >= cstr_len || csep_len == 0)
+    return gab_vmpush(gab_thisvm(gab), gab_none), gab_union_cvalid(gab_nil);
+
+  const char *cstr = gab_strdata(&str);
+  const char *csep = gab_strdata(&sep);
+
+  for (uint64_t offset = begin; offset + csep_len <= cstr_len;) {
+    const char *match =
+        memchr(cstr + offset, csep[0], cstr_len - csep_len - offset + 1);
+
+    if (!match)
+      break;
+
+    offset = match - cstr;
+
+    if (!memcmp(match, csep, csep_len)) {
+      gab_vmpush(gab_thisvm(gab), gab_ok, gab_number(offset + csep_len),
+                 gab_nstring(gab, offset - begin, cstr + begin));
+      return gab_union_cvalid(gab_nil);
+    }
+
+    offset++;
+  }
+
+  gab_vmpush(gab_thisvm(gab), gab_ok, gab_number(cstr_len),
+             gab_nstring(gab, cstr_len - begin, cstr + begin));
+  return gab_union_cvalid(gab_nil);
+}
+
 GAB_DYNLIB_NATIVE_FN(binary, len) {
   gab_value result = gab_number(gab_strlen(argv[0]));
 
@@ -362,54 +427,168 @@ GAB_DYNLIB_NATIVE_FN(binary, at) {
   return gab_union_cvalid(gab_nil);
 }
 
-GAB_DYNLIB_NATIVE_FN(string, at) {
-  if (argc != 2 && gab_valkind(argv[1]) != kGAB_NUMBER) {
-    return gab_panicf(gab, "&:at expects 1 number argument");
+/*
+ * Strings at least GRAPHEME_CRUMB_MINLEN bytes long cache the byte offset of
+ * every GRAPHEME_CRUMB_STRIDE'th grapheme. Finding a grapheme then means
+ * walking fewer than GRAPHEME_CRUMB_STRIDE graphemes, instead of the
+ * whole string up to it.
+ *
+ * An ascii string without any "\r\n" has one grapheme per byte. This is
+ * cached as 'bytewise', with no offsets, so that it is only scanned for once.
+ */
+#define GRAPHEME_CRUMB_STRIDE 64
+#define GRAPHEME_CRUMB_MINLEN 256
+
+struct grapheme_crumbs {
+  bool bytewise;
+  uint64_t count;
+  uint64_t offsets[];
+};
+
+struct graphemes {
+  const char *data;
+  uint64_t len, count;
+  const struct grapheme_crumbs *crumbs;
+};
+
+static inline bool is_bytewise(bool ascii, const char *data, uint64_t len) {
+  return ascii && !memchr(data, '\r', len);
+}
+
+static uint64_t count_graphemes(bool ascii, const char *data, uint64_t len) {
+  if (is_bytewise(ascii, data, len))
+    return len;
+
+  uint64_t count = 0;
+
+  for (uint64_t offset = 0; offset < len; count++)
+    offset += grapheme_next_character_break_utf8(data + offset, len - offset);
+
+  return count;
+}
+
+static const struct grapheme_crumbs *build_crumbs(bool ascii, const char *data,
+                                                  uint64_t len) {
+  if (is_bytewise(ascii, data, len)) {
+    struct grapheme_crumbs *crumbs = malloc(sizeof(struct grapheme_crumbs));
+
+    if (!crumbs)
+      return nullptr;
+
+    crumbs->bytewise = true;
+    crumbs->count = len;
+    return crumbs;
   }
 
-  int64_t index = gab_valtoi(argv[1]);
+  struct grapheme_crumbs *crumbs =
+      malloc(sizeof(struct grapheme_crumbs) +
+             (len / GRAPHEME_CRUMB_STRIDE + 1) * sizeof(uint64_t));
 
-  if (index < 0) {
-    // Go from the back
-    index = gab_strlen(argv[0]) + index;
+  if (!crumbs)
+    return nullptr;
+
+  uint64_t count = 0, offset = 0;
+
+  while (offset < len) {
+    if (count % GRAPHEME_CRUMB_STRIDE == 0)
+      crumbs->offsets[count / GRAPHEME_CRUMB_STRIDE] = offset;
+
+    offset += grapheme_next_character_break_utf8(data + offset, len - offset);
+    count++;
   }
 
-  if (index >= gab_strlen(argv[0])) {
-    gab_vmpush(gab_thisvm(gab), gab_none);
-    return gab_union_cvalid(gab_nil);
+  crumbs->bytewise = false;
+  crumbs->count = count;
+  return crumbs;
+}
+
+/*
+ * Get the graphemes of the string at 'str'. This is a pointer, as
+ * gab_strdata may point into the value itself.
+ */
+static struct graphemes graphemes_of(gab_value *str) {
+  struct graphemes g = {
+      .data = gab_strdata(str),
+      .len = gab_strlen(*str),
+  };
+
+  bool ascii = gab_strisascii(*str);
+
+  if (g.len < GRAPHEME_CRUMB_MINLEN)
+    return (g.count = count_graphemes(ascii, g.data, g.len)), g;
+
+  g.crumbs = gab_strindex(*str);
+
+  if (!g.crumbs) {
+    g.crumbs = build_crumbs(ascii, g.data, g.len);
+
+    // Another thread may have beaten us to it.
+    if (g.crumbs && !gab_strsetindex(*str, (void *)g.crumbs)) {
+      free((void *)g.crumbs);
+      g.crumbs = gab_strindex(*str);
+    }
   }
 
-  // Woah, this ain't right.
-  char byte = gab_strdata(argv + 0)[index];
+  if (!g.crumbs)
+    return (g.count = count_graphemes(ascii, g.data, g.len)), g;
 
-  gab_vmpush(gab_thisvm(gab), gab_ok, gab_nstring(gab, 1, &byte));
-  return gab_union_cvalid(gab_nil);
+  g.count = g.crumbs->count;
+  return g;
 }
 
-s_char utf8_slice(const char *data, size_t len, size_t from, size_t to) {
-  size_t graphemes = 0, offset = 0;
+/*
+ * The byte offset of the nth grapheme, or the length of the string if there
+ * are not that many.
+ */
+static uint64_t grapheme_offset(const struct graphemes *g, uint64_t n) {
+  if (n >= g->count)
+    return g->len;
 
-  while (graphemes < from) {
-    graphemes++;
+  if (g->count == g->len)
+    return n;
+
+  uint64_t i = 0, offset = 0;
+
+  if (g->crumbs) {
+    i = n - n % GRAPHEME_CRUMB_STRIDE;
+    offset = g->crumbs->offsets[n / GRAPHEME_CRUMB_STRIDE];
+  }
+
+  for (; i < n; i++)
+    offset += grapheme_next_character_break_utf8(g->data + offset,
+                                                 g->len - offset);
+
+  return offset;
+}
 
-    assert(offset < len);
-    offset += grapheme_next_character_break_utf8(data + offset, SIZE_MAX);
+GAB_DYNLIB_NATIVE_FN(string, at) {
+  if (argc < 2 || gab_valkind(argv[1]) != kGAB_NUMBER) {
+    return gab_panicf(gab, "&:at expects 1 number argument");
   }
 
-  s_char result = s_char_create(data + offset, 0);
-  while (graphemes < to) {
-    graphemes++;
+  if (gab_valkind(argv[0]) != kGAB_STRING)
+    return gab_pktypemismatch(gab, argv[0], kGAB_STRING);
 
-    assert(offset < len);
-    size_t grapheme_size =
-        grapheme_next_character_break_utf8(data + offset, SIZE_MAX);
+  struct graphemes g = graphemes_of(argv + 0);
 
-    offset += grapheme_size;
+  int64_t index = gab_valtoi(argv[1]);
 
-    result.len += grapheme_size;
+  if (index < 0) {
+    // Go from the back
+    index = g.count + index;
   }
 
-  return result;
+  if (index < 0 || index >= g.count) {
+    gab_vmpush(gab_thisvm(gab), gab_none);
+    return gab_union_cvalid(gab_nil);
+  }
+
+  uint64_t from = grapheme_offset(&g, index);
+  uint64_t to = grapheme_offset(&g, index + 1);
+
+  gab_vmpush(gab_thisvm(gab), gab_ok,
+             gab_nstring(gab, to - from, g.data + from));
+  return gab_union_cvalid(gab_nil);
 }
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -422,8 +601,8 @@ GAB_DYNLIB_NATIVE_FN(string, slice) {
   if (gab_valkind(str) != kGAB_STRING)
     return gab_pktypemismatch(gab, str, kGAB_STRING);
 
-  const char *data = gab_strdata(&str);
-  uint64_t len = gab_strlen(str);
+  struct graphemes g = graphemes_of(&str);
+  uint64_t len = g.count;
 
   gab_value vfrom = gab_arg(1);
   gab_value vto = gab_arg(2);
@@ -444,21 +623,22 @@ GAB_DYNLIB_NATIVE_FN(string, slice) {
     return gab_pktypemismatch(gab, vto, kGAB_NUMBER);
 
   int64_t from = gab_valtoi(vfrom);
-  while (from < 0)
+  while (len && from < 0)
     from += len;
-  from = CLAMP(from, len);
+  from = CLAMP(from, (int64_t)len);
 
   int64_t to = gab_valtoi(vto);
-  while (to < 0)
+  while (len && to < 0)
     to += len;
-  to = CLAMP(to, len);
+  to = CLAMP(to, (int64_t)len);
 
   if (from > to)
     return gab_panicf(gab, "Cannot slice from @ to @", vfrom, vto);
 
-  s_char result = utf8_slice(data, len, from, to);
+  uint64_t begin = grapheme_offset(&g, from);
+  uint64_t end = grapheme_offset(&g, to);
 
-  gab_value res = gab_nstring(gab, result.len, result.data);
+  gab_value res = gab_nstring(gab, end - begin, g.data + begin);
 
   gab_vmpush(gab_thisvm(gab), res);
   return gab_union_cvalid(gab_nil);
@@ -500,7 +680,8 @@ GAB_DYNLIB_NATIVE_FN(number, tob) {
 }
 
 GAB_DYNLIB_NATIVE_FN(string, tom) {
-  gab_vmpush(gab_thisvm(gab), gab_strtomsg(gab_arg(0)));
+  // Messages are compared by identity, so big strings must be interned first.
+  gab_vmpush(gab_thisvm(gab), gab_strtomsg(gab_strintern(gab, gab_arg(0))));
   return gab_union_cvalid(gab_nil);
 }
 
@@ -628,8 +809,297 @@ GAB_DYNLIB_NATIVE_FN(fmt, psprintf) {
   }
 }
 
+/*
+ * String builders.
+ *
+ * Concatenating with '+' makes (and interns) a new string every time, which is
+ * quadratic when building up output in a loop. A builder appends into one
+ * growable buffer, and only makes a string when frozen.
+ */
+void builder_destroy(struct gab_triple gab, uint64_t len, char *data) {
+  struct gab_strbuilder *b = (struct gab_strbuilder *)data;
+  free(b->data);
+}
+
+static inline bool builder_reserve(struct gab_strbuilder *b, uint64_t n) {
+  if (b->cap - b->len >= n)
+    return true;
+
+  uint64_t cap = b->cap ? b->cap : 64;
+  while (cap - b->len < n)
+    cap *= 2;
+
+  char *data = realloc(b->data, cap);
+
+  if (!data)
+    return false;
+
+  b->data = data;
+  b->cap = cap;
+  return true;
+}
+
+static inline bool isbuilder(struct gab_triple gab, gab_value v) {
+  return gab_valkind(v) == kGAB_BOX &&
+         gab_boxtype(v) == gab_string(gab, tGAB_STRBUILDER);
+}
+
+/*
+ * No value prints to more than this. Past it, something other than the size of
+ * the buffer is failing - so stop growing it.
+ */
+#define BUILDER_INSPECT_MAX ((uint64_t)1 << 31)
+
+/*
+ * Append a value as it would print, returning an error message if it can't be.
+ *
+ * gab_svalinspect uses up all of the remaining space when the buffer is too
+ * small. So the buffer is only grown when that happened - any other failure
+ * is reported rather than retried.
+ */
+static const char *builder_inspect(struct gab_strbuilder *b, gab_value v,
+                                   int depth) {
+  for (uint64_t n = 64;; n *= 2) {
+    if (n > BUILDER_INSPECT_MAX)
+      return "Value is too big to print";
+
+    if (!builder_reserve(b, n))
+      return "Builder too big";
+
+    char *cursor = b->data + b->len;
+    uint64_t remaining = b->cap - b->len;
+
+    if (gab_svalinspect(&cursor, &remaining, v, depth) >= 0) {
+      b->len = cursor - b->data;
+      return nullptr;
+    }
+
+    if (remaining != 0)
+      return "Failed to print value";
+  }
+}
+
+/*
+ * Append each value to the builder. Strings, binaries, messages and other
+ * builders are appended as they are, everything else as it would print.
+ */
+const char *builder_append(struct gab_triple gab, struct gab_strbuilder *b,
+                           uint64_t argc, gab_value *argv) {
+  for (uint64_t i = 0; i < argc; i++) {
+    gab_value v = argv[i];
+
+    switch (gab_valkind(v)) {
+    case kGAB_STRING:
+    case kGAB_BINARY:
+    case kGAB_MESSAGE: {
+      uint64_t len = gab_strlen(v);
+
+      if (!builder_reserve(b, len))
+        return "Builder too big";
+
+      memcpy(b->data + b->len, gab_strdata(argv + i), len);
+      b->len += len;
+      break;
+    }
+    case kGAB_BOX:
+      if (isbuilder(gab, v)) {
+        struct gab_strbuilder *other = gab_boxdata(v);
+        uint64_t len = other->len;
+
+        if (!builder_reserve(b, len))
+          return "Builder too big";
+
+        memmove(b->data + b->len, other->data, len);
+        b->len += len;
+        break;
+      }
+      [[fallthrough]];
+    default: {
+      const char *err = builder_inspect(b, v, -1);
+
+      if (err)
+        return err;
+    }
+    }
+  }
+
+  return nullptr;
+}
+
+GAB_DYNLIB_NATIVE_FN(builder, make) {
+  gab_value builder =
+      gab_box(gab, (struct gab_box_argt){
+                       .size = sizeof(struct gab_strbuilder),
+                       .type = gab_string(gab, tGAB_STRBUILDER),
+                       .destructor = builder_destroy,
+                   });
+
+  const char *err =
+      builder_append(gab, gab_boxdata(builder), argc - 1, argv + 1);
+
+  if (err)
+    return gab_panicf(gab, err);
+
+  gab_vmpush(gab_thisvm(gab), builder);
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(builder, append) {
+  gab_value builder = gab_arg(0);
+
+  const char *err =
+      builder_append(gab, gab_boxdata(builder), argc - 1, argv + 1);
+
+  if (err)
+    return gab_panicf(gab, err);
+
+  gab_vmpush(gab_thisvm(gab), builder);
+  return gab_union_cvalid(gab_nil);
+}
+
+/*
+ * The number of holes in a format. '$' is ascii, so it can't appear inside a
+ * multi-byte sequence.
+ */
+static uint64_t fmt_nholes(const char *fmt) {
+  uint64_t n = 0;
+
+  for (const char *c = fmt; (c = strchr(c, '$')); c++)
+    n++;
+
+  return n;
+}
+
+/*
+ * Format straight into the builder, as gab_nsprintf would.
+ *
+ * The text between holes is copied as it is, and each argument is printed in
+ * place - so only an argument which doesn't fit is ever retried.
+ */
+GAB_DYNLIB_NATIVE_FN(builder, appendf) {
+  gab_value builder = gab_arg(0);
+  gab_value fmtstr = gab_arg(1);
+
+  if (gab_valkind(fmtstr) != kGAB_STRING)
+    return gab_pktypemismatch(gab, fmtstr, kGAB_STRING);
+
+  struct gab_strbuilder *b = gab_boxdata(builder);
+  const char *fmt = gab_strdata(argv + 1);
+
+  uint64_t holes = fmt_nholes(fmt);
+
+  if (holes != argc - 2)
+    return gab_panicf(gab, "Format @ expects @ arguments, got @", fmtstr,
+                      gab_number(holes), gab_number(argc - 2));
+
+  for (uint64_t i = 2;; i++) {
+    const char *hole = strchr(fmt, '$');
+    uint64_t len = hole ? hole - fmt : strlen(fmt);
+
+    if (!builder_reserve(b, len))
+      return gab_panicf(gab, "Builder too big");
+
+    memcpy(b->data + b->len, fmt, len);
+    b->len += len;
+
+    if (!hole)
+      break;
+
+    const char *err = builder_inspect(b, argv[i], 1);
+
+    if (err)
+      return gab_panicf(gab, "$, of type $", gab_string(gab, err),
+                        gab_valtype(gab, argv[i]));
+
+    fmt = hole + 1;
+  }
+
+  gab_vmpush(gab_thisvm(gab), builder);
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(builder, freeze) {
+  struct gab_strbuilder *b = gab_boxdata(gab_arg(0));
+
+  gab_value str = gab_nstring(gab, b->len, b->data);
+
+  if (gab_strmblen(str) == -1)
+    return gab_panicf(gab, "Builder does not hold valid utf8");
+
+  gab_vmpush(gab_thisvm(gab), str);
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(builder, tob) {
+  struct gab_strbuilder *b = gab_boxdata(gab_arg(0));
+
+  gab_vmpush(gab_thisvm(gab),
+             gab_nbinary(gab, b->len, (const uint8_t *)b->data));
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(builder, len) {
+  struct gab_strbuilder *b = gab_boxdata(gab_arg(0));
+
+  gab_vmpush(gab_thisvm(gab), gab_number(b->len));
+  return gab_union_cvalid(gab_nil);
+}
+
+GAB_DYNLIB_NATIVE_FN(builder, clear) {
+  gab_value builder = gab_arg(0);
+  struct gab_strbuilder *b = gab_boxdata(builder);
+
+  b->len = 0;
+
+  gab_vmpush(gab_thisvm(gab), builder);
+  return gab_union_cvalid(gab_nil);
+}
+
 GAB_DYNLIB_MAIN_FN {
   gab_value t = gab_type(gab, kGAB_STRING);
+  gab_value bt = gab_string(gab, tGAB_STRBUILDER);
+
+  gab_def(gab,
+          {
+              gab_message(gab, "builder"),
+              gab_strtomsg(t),
+              gab_snative(gab, "builder", gab_mod_builder_make),
+          },
+          {
+              gab_message(gab, "append"),
+              bt,
+              gab_snative(gab, "append", gab_mod_builder_append),
+          },
+          {
+              gab_message(gab, "appendf"),
+              bt,
+              gab_snative(gab, "appendf", gab_mod_builder_appendf),
+          },
+          {
+              gab_message(gab, "freeze"),
+              bt,
+              gab_snative(gab, "freeze", gab_mod_builder_freeze),
+          },
+          {
+              gab_message(gab, "to\\string"),
+              bt,
+              gab_snative(gab, "to\\string", gab_mod_builder_freeze),
+          },
+          {
+              gab_message(gab, "to\\binary"),
+              bt,
+              gab_snative(gab, "to\\binary", gab_mod_builder_tob),
+          },
+          {
+              gab_message(gab, "len"),
+              bt,
+              gab_snative(gab, "len", gab_mod_builder_len),
+          },
+          {
+              gab_message(gab, "clear"),
+              bt,
+              gab_snative(gab, "clear", gab_mod_builder_clear),
+          });
 
   gab_def(gab,
           {
@@ -647,6 +1117,11 @@ GAB_DYNLIB_MAIN_FN {
               t,
               gab_snative(gab, "split", gab_mod_string_split),
           },
+          {
+              gab_message(gab, "split\\next"),
+              t,
+              gab_snative(gab, "split\\next", gab_mod_string_split_next),
+          },
           {
               gab_message(gab, "has\\sub"),
               t,
@@ -118,29 +118,132 @@ typedef struct clay_sg_image {
   sg_view view;
 } clay_sg_image;
 
-struct ui_image {
+enum gui_kind { kGAB_GUI, kGAB_TUI, kGAB_HUI };
+
+/*
+ * Images are decoded off the ui thread, so that a frame doesn't stall on a
+ * large one. The job belongs to a decoder once it is queued, until it
+ * publishes a state other than kUI_IMAGE_PENDING - after which it belongs to
+ * the ui thread again.
+ */
+enum ui_image_state {
+  kUI_IMAGE_PENDING,
+  kUI_IMAGE_DECODED,
+  kUI_IMAGE_FAILED,
+};
+
+struct ui_image_job {
+  _Atomic enum ui_image_state state;
+  enum gui_kind k;
+  gab_value data;
+
+  // The next job in the decoders' queue.
+  struct ui_image_job *next;
+
+  union {
+    struct {
+      unsigned char *pixels;
+      int width, height;
+    } gui;
+#if HAS_TERMBOX
+    clay_tb_image tui;
+#endif
+  } as;
+};
 
+struct ui_image {
   union {
     clay_sg_image gui;
 #if HAS_TERMBOX
     clay_tb_image tui;
 #endif
   } as;
+
+  // Non-null while the image is still being decoded.
+  struct ui_image_job *job;
+
+  // The frame this image was last drawn in, and the memory it holds.
+  uint64_t frame, bytes;
+
+  bool ready;
 };
 
+/*
+ * Images are kept behind a pointer, as Clay holds on to them until the frame
+ * is drawn - and the dict may move its buckets in the meantime.
+ */
 #define K gab_value
-#define V struct ui_image
+#define V struct ui_image *
 #define NAME ui_image
 #define HASH(v) (gab_strhash(v))
+#define EQUAL(a, b) (gab_valequal(a, b))
+#define DEF_V nullptr
+#include "dict.h"
+
+/*
+ * Layout and transition configs parsed from a props record.
+ *
+ * Records are immutable, and an app which only changes a small part of its
+ * tree between frames hands us the very same props records for the rest of
+ * it. Clay needs every element declared each frame, but the props behind
+ * unchanged elements don't need parsing again.
+ */
+struct ui_props {
+  uint64_t frame;
+  Clay_LayoutConfig layout;
+  Clay_TransitionElementConfig transition;
+};
+
+#define K gab_value
+#define V struct ui_props
+#define NAME ui_props
+#define HASH(v) ((uint64_t)(v) * 0x9e3779b97f4a7c15ull)
 #define EQUAL(a, b) (a == b)
-#define DEF_V ((struct ui_image){0})
+#define DEF_V ((struct ui_props){0})
+#include "dict.h"
+
+/*
+ * A copy of a text component's content. Clay keeps the pointer until the
+ * frame is drawn, and short strings live inside the gab_value itself.
+ */
+struct ui_text {
+  uint64_t frame;
+  char *chars;
+};
+
+#define K gab_value
+#define V struct ui_text
+#define NAME ui_text
+#define HASH(v) (gab_strhash(v))
+#define EQUAL(a, b) (gab_valequal(a, b))
+#define DEF_V ((struct ui_text){0})
 #include "dict.h"
 
+// The number of threads decoding images, per ui.
+#define IMAGE_DECODERS 2
+
+/*
+ * A small pool of threads, started on the first image, which decode the jobs
+ * in their queue in order. They are stopped and joined when the ui closes.
+ */
+struct ui_decoders {
+  mtx_t mtx;
+  cnd_t cnd;
+  bool stop;
+  uint8_t len;
+  thrd_t threads[IMAGE_DECODERS];
+  struct ui_image_job *head, *tail;
+};
+
 struct ui {
+  struct ui_decoders decoders;
   d_ui_image image_cache;
-  gab_value appch, evch;
+  d_ui_props props_cache;
+  d_ui_text text_cache;
+  uint64_t frame, image_bytes, image_jobs;
+  gab_value appch, evch, last;
   uint64_t n;
-  enum gui_kind { kGAB_GUI, kGAB_TUI, kGAB_HUI } k;
+  enum gui_kind k;
   bool ready;
   union {
     struct RGFW_window win;
@@ -150,6 +253,12 @@ struct ui {
 #define MAX_MS_PER_FRAME 15 
 #define CHNTAKE_WAITTIME 0
 
+// Decoded images past this many bytes are evicted, least recently drawn first.
+#define IMAGE_CACHE_BYTES (256ull << 20)
+
+// Images larger than this in either dimension are scaled down when decoded.
+#define IMAGE_MAX_DIM 4096
+
 struct timestep {
   clock_t dt;
   double dt_d;
@@ -633,6 +742,100 @@ Clay_TransitionElementConfig parseTransition(struct gab_triple gab,
   };
 }
 
+struct ui_props props_cache_read(struct gab_triple gab, struct ui *gui,
+                                 gab_value props) {
+  size_t idx = d_ui_props_index_of(&gui->props_cache, props);
+
+  if (d_ui_props_iexists(&gui->props_cache, idx)) {
+    struct ui_props *cached = &gui->props_cache.buckets[idx].val;
+    cached->frame = gui->frame;
+    return *cached;
+  }
+
+  struct ui_props insert = {
+      .frame = gui->frame,
+      .layout = parseLayout(gab, props),
+      .transition = parseTransition(gab, props),
+  };
+
+  // Hold on to the record, so that its address isn't reused by another
+  // while we still have an entry for it.
+  gab_iref(gab, props);
+  d_ui_props_insert(&gui->props_cache, props, insert);
+
+  return insert;
+}
+
+const char *text_cache_read(struct gab_triple gab, struct ui *gui,
+                            gab_value content) {
+  size_t idx = d_ui_text_index_of(&gui->text_cache, content);
+
+  if (d_ui_text_iexists(&gui->text_cache, idx)) {
+    struct ui_text *cached = &gui->text_cache.buckets[idx].val;
+    cached->frame = gui->frame;
+    return cached->chars;
+  }
+
+  uint64_t len = gab_strlen(content);
+  char *str = malloc(len + 1);
+  gab_assert(str != nullptr, "Assume malloc can't fail");
+  memcpy(str, gab_strdata(&content), len);
+  str[len] = '\0';
+
+  gab_iref(gab, content);
+  d_ui_text_insert(&gui->text_cache, content,
+                   (struct ui_text){.frame = gui->frame, .chars = str});
+
+  return str;
+}
+
+void image_cache_trim(struct gab_triple gab, struct ui *gui);
+
+/*
+ * Hold on to the app we just drew, taking over the reference held for the
+ * frame. Should an image it shows finish decoding, we draw it again.
+ */
+void keep_last(struct gab_triple gab, struct ui *gui, gab_value app) {
+  if (gui->last != gab_cundefined)
+    gab_dref(gab, gui->last);
+
+  gui->last = app;
+}
+
+/*
+ * Drop the entries which weren't used to render the last frame, and begin the
+ * next one. This keeps the caches to the size of what is on screen.
+ */
+void caches_endframe(struct gab_triple gab, struct ui *gui) {
+  for (size_t i = 0; i < gui->props_cache.cap; i++) {
+    if (!d_ui_props_iexists(&gui->props_cache, i))
+      continue;
+
+    if (d_ui_props_ival(&gui->props_cache, i).frame == gui->frame)
+      continue;
+
+    gab_dref(gab, d_ui_props_ikey(&gui->props_cache, i));
+    d_ui_props_iremove(&gui->props_cache, i);
+  }
+
+  for (size_t i = 0; i < gui->text_cache.cap; i++) {
+    if (!d_ui_text_iexists(&gui->text_cache, i))
+      continue;
+
+    struct ui_text text = d_ui_text_ival(&gui->text_cache, i);
+    if (text.frame == gui->frame)
+      continue;
+
+    free(text.chars);
+    gab_dref(gab, d_ui_text_ikey(&gui->text_cache, i));
+    d_ui_text_iremove(&gui->text_cache, i);
+  }
+
+  image_cache_trim(gab, gui);
+
+  gui->frame++;
+}
+
 [[nodiscard]]
 union gab_value_pair
 render_componentlist(struct gab_triple gab, struct ui *gui, gab_value app,
@@ -701,7 +904,8 @@ union gab_value_pair render_box(struct gab_triple gab, struct ui *gui,
   if (vid != gab_cundefined && gab_valkind(vid) != kGAB_MESSAGE)
     return gab_pktypemismatch(gab, vid, kGAB_MESSAGE);
 
-  Clay_LayoutConfig layout = parseLayout(gab, props);
+  struct ui_props parsed = props_cache_read(gab, gui, props);
+  Clay_LayoutConfig layout = parsed.layout;
 
   gab_uint border_w = gab_valtou(vborderWidth);
 
@@ -715,7 +919,7 @@ union gab_value_pair render_box(struct gab_triple gab, struct ui *gui,
                    cornerRadius,
                    cornerRadius,
                },
-           .transition = parseTransition(gab, props),
+           .transition = parsed.transition,
            .backgroundColor = packedToClayColor(vbg),
            .border =
                {
@@ -786,7 +990,7 @@ union gab_value_pair render_rect(struct gab_triple gab, struct ui *gui,
 
   CLAY(UI_ID(vid), {
                        .backgroundColor = packedToClayColor(vcolor),
-                       .layout = parseLayout(gab, props),
+                       .layout = props_cache_read(gab, gui, props).layout,
                        .floating =
                            {
                                .attachTo = CLAY_ATTACH_TO_ROOT,
@@ -798,72 +1002,402 @@ union gab_value_pair render_rect(struct gab_triple gab, struct ui *gui,
   return gab_union_cvalid(gab_nil);
 }
 
-const struct ui_image *image_cache_read(struct gab_triple gab, struct ui *gui,
-                                        gab_value data) {
-  gab_assert(gab.wkid == 1, "Can only run on main thread");
+void image_decode_job(struct ui_image_job *job) {
 
-  size_t idx = d_ui_image_index_of(&gui->image_cache, data);
-  if (d_ui_image_iexists(&gui->image_cache, idx))
-    return &gui->image_cache.buckets[idx].val;
+  const unsigned char *bytes = (const void *)gab_strdata(&job->data);
+  int len = gab_strlen(job->data);
 
-  struct ui_image insert = {};
+  enum ui_image_state state = kUI_IMAGE_DECODED;
 
-  switch (gui->k) {
+  switch (job->k) {
   case kGAB_GUI: {
     const int desired_color_channels = 4;
+    int w, h, channels;
+
+    unsigned char *pixels = stbi_load_from_memory(bytes, len, &w, &h, &channels,
+                                                  desired_color_channels);
+
+    if (pixels == nullptr) {
+      state = kUI_IMAGE_FAILED;
+      break;
+    }
+
+    if (w > IMAGE_MAX_DIM || h > IMAGE_MAX_DIM) {
+      double scale = (double)IMAGE_MAX_DIM / (w > h ? w : h);
+      int sw = w * scale, sh = h * scale;
+      sw = sw ? sw : 1, sh = sh ? sh : 1;
+
+      unsigned char *scaled = stbir_resize_uint8_linear(
+          pixels, w, h, 0, nullptr, sw, sh, 0, STBIR_RGBA);
+
+      // If we can't scale it, hand over the original and hope for the best.
+      if (scaled != nullptr) {
+        stbi_image_free(pixels);
+        pixels = scaled, w = sw, h = sh;
+      }
+    }
+
+    job->as.gui.pixels = pixels;
+    job->as.gui.width = w;
+    job->as.gui.height = h;
+    break;
+  }
+#if HAS_TERMBOX
+  case kGAB_TUI:
+    job->as.tui = Clay_Termbox_Image_Load_Memory(bytes, len);
+    break;
+#endif
+  case kGAB_HUI:
+    break;
+  }
+
+  atomic_store(&job->state, state);
+}
+
+int image_decoder(void *data) {
+  struct ui_decoders *d = data;
+
+  mtx_lock(&d->mtx);
+
+  for (;;) {
+    while (!d->stop && d->head == nullptr)
+      cnd_wait(&d->cnd, &d->mtx);
+
+    // Jobs still queued are left for image_cache_destroy.
+    if (d->stop)
+      break;
+
+    struct ui_image_job *job = d->head;
+    d->head = job->next;
+
+    if (d->head == nullptr)
+      d->tail = nullptr;
+
+    mtx_unlock(&d->mtx);
+    image_decode_job(job);
+    mtx_lock(&d->mtx);
+  }
+
+  mtx_unlock(&d->mtx);
+  return 0;
+}
+
+void image_decode(struct ui *gui, struct ui_image *img, gab_value data) {
+  struct ui_image_job *job = malloc(sizeof(struct ui_image_job));
+  gab_assert(job != nullptr, "Assume malloc can't fail");
+
+  job->k = gui->k;
+  job->data = data;
+  job->next = nullptr;
+  atomic_init(&job->state, kUI_IMAGE_PENDING);
+
+  img->job = job;
+  gui->image_jobs++;
+
+  struct ui_decoders *d = &gui->decoders;
 
-    insert.as.gui.pixels = stbi_load_from_memory(
-        (const void *)gab_strdata(&data), gab_strlen(data),
-        &insert.as.gui.width, &insert.as.gui.height, &insert.as.gui.channels,
-        desired_color_channels);
+  mtx_lock(&d->mtx);
 
-    insert.as.gui.channels = 4;
+  // Start another decoder while there is more work queued than threads.
+  if (d->len < IMAGE_DECODERS && d->len < gui->image_jobs &&
+      thrd_create(d->threads + d->len, image_decoder, d) == thrd_success)
+    d->len++;
 
-    insert.as.gui.img = sg_make_image(&(struct sg_image_desc){
+  // Without any decoder at all, we have to decode it ourselves.
+  if (d->len == 0) {
+    mtx_unlock(&d->mtx);
+    image_decode_job(job);
+    return;
+  }
+
+  if (d->tail)
+    d->tail->next = job;
+  else
+    d->head = job;
+
+  d->tail = job;
+
+  cnd_signal(&d->cnd);
+  mtx_unlock(&d->mtx);
+}
+
+/*
+ * Take the result of a finished decode. Uploading to the gpu has to happen
+ * here, on the ui thread, which owns the graphics context.
+ */
+bool image_finish(struct ui *gui, struct ui_image *img) {
+  struct ui_image_job *job = img->job;
+
+  enum ui_image_state state = atomic_load(&job->state);
+  if (state == kUI_IMAGE_PENDING)
+    return false;
+
+  img->job = nullptr;
+  gui->image_jobs--;
+
+  if (state == kUI_IMAGE_FAILED)
+    return free(job), true;
+
+  switch (job->k) {
+  case kGAB_GUI: {
+    clay_sg_image *sg = &img->as.gui;
+    sg->width = job->as.gui.width;
+    sg->height = job->as.gui.height;
+    sg->channels = 4;
+
+    sg->img = sg_make_image(&(struct sg_image_desc){
         .type = SG_IMAGETYPE_2D,
         .usage.immutable = true,
-        .width = insert.as.gui.width,
-        .height = insert.as.gui.height,
+        .width = sg->width,
+        .height = sg->height,
         .pixel_format = SG_PIXELFORMAT_RGBA8,
         .data.mip_levels[0] =
             {
-                .ptr = insert.as.gui.pixels,
-                .size = (insert.as.gui.width * insert.as.gui.height *
-                         insert.as.gui.channels),
+                .ptr = job->as.gui.pixels,
+                .size = (sg->width * sg->height * sg->channels),
             },
     });
 
-    sg_resource_state state = sg_query_image_state(insert.as.gui.img);
-    gab_assert(state == SG_RESOURCESTATE_VALID, "Image state should be valid");
+    sg_resource_state sgstate = sg_query_image_state(sg->img);
+    gab_assert(sgstate == SG_RESOURCESTATE_VALID,
+               "Image state should be valid");
 
-    insert.as.gui.view = sg_make_view(&(struct sg_view_desc){
-        .texture.image = insert.as.gui.img,
+    sg->view = sg_make_view(&(struct sg_view_desc){
+        .texture.image = sg->img,
     });
 
-    state = sg_query_view_state(insert.as.gui.view);
-    gab_assert(state == SG_RESOURCESTATE_VALID, "View state should be valid");
+    sgstate = sg_query_view_state(sg->view);
+    gab_assert(sgstate == SG_RESOURCESTATE_VALID,
+               "View state should be valid");
 
-    insert.as.gui.sclay = (sclay_image){
-        .view = insert.as.gui.view,
+    sg->sclay = (sclay_image){
+        .view = sg->view,
     };
+
+    // The image is immutable, so sokol has its own copy now. Both stb_image
+    // and stb_image_resize2 allocate with malloc.
+    free(job->as.gui.pixels);
+    sg->pixels = nullptr;
+
+    img->bytes = (uint64_t)sg->width * sg->height * sg->channels;
     break;
   }
 #if HAS_TERMBOX
-  case kGAB_TUI: {
-    insert.as.tui =
-        Clay_Termbox_Image_Load_Memory(gab_strdata(&data), gab_strlen(data));
+  case kGAB_TUI:
+    img->as.tui = job->as.tui;
+    img->bytes = (uint64_t)img->as.tui.pixel_width * img->as.tui.pixel_height * 4;
     break;
-  }
 #endif
   case kGAB_HUI:
     break;
   }
 
-  bool inserted = d_ui_image_insert(&gui->image_cache, data, insert);
-  gab_assert(inserted, "Image should have inserted");
+  img->ready = true;
+  gui->image_bytes += img->bytes;
 
-  return &gui->image_cache.buckets[idx].val;
-};
+  free(job);
+  return true;
+}
+
+void image_evict(struct gab_triple gab, struct ui *gui, size_t idx) {
+  struct ui_image *img = d_ui_image_ival(&gui->image_cache, idx);
+
+  // Only on teardown, once the decoders are joined - see image_cache_destroy.
+  if (img->job != nullptr) {
+    struct ui_image_job *job = img->job;
+
+    if (atomic_load(&job->state) == kUI_IMAGE_DECODED) {
+      switch (job->k) {
+      case kGAB_GUI:
+        free(job->as.gui.pixels);
+        break;
+#if HAS_TERMBOX
+      case kGAB_TUI:
+        Clay_Termbox_Image_Free(&job->as.tui);
+        break;
+#endif
+      case kGAB_HUI:
+        break;
+      }
+    }
+
+    img->job = nullptr;
+    gui->image_jobs--;
+    free(job);
+  }
+
+  if (img->ready) {
+    switch (gui->k) {
+    case kGAB_GUI:
+      sg_destroy_view(img->as.gui.view);
+      sg_destroy_image(img->as.gui.img);
+      break;
+#if HAS_TERMBOX
+    case kGAB_TUI:
+      Clay_Termbox_Image_Free(&img->as.tui);
+      break;
+#endif
+    case kGAB_HUI:
+      break;
+    }
+  }
+
+  gui->image_bytes -= img->bytes;
+
+  gab_dref(gab, d_ui_image_ikey(&gui->image_cache, idx));
+  d_ui_image_iremove(&gui->image_cache, idx);
+  free(img);
+}
+
+/*
+ * Finish any decodes which completed since we last looked. Returns true if
+ * there was at least one, as the last frame is then worth drawing again.
+ */
+bool image_cache_poll(struct ui *gui) {
+  if (gui->image_jobs == 0)
+    return false;
+
+  bool finished = false;
+
+  for (size_t i = 0; i < gui->image_cache.cap; i++) {
+    if (!d_ui_image_iexists(&gui->image_cache, i))
+      continue;
+
+    struct ui_image *img = d_ui_image_ival(&gui->image_cache, i);
+
+    if (img->job != nullptr)
+      finished |= image_finish(gui, img);
+  }
+
+  return finished;
+}
+
+/*
+ * Entries which failed to decode (and hui's, which are never decoded) hold
+ * nothing but their binary - drop them as soon as they go off screen.
+ *
+ * Then evict the least recently drawn images until we fit into our budget
+ * again. Images drawn in the current frame are still referenced by Clay, and
+ * images still decoding belong to their job - neither are candidates. A
+ * decode which finishes after its image went off screen is swept here on the
+ * next frame.
+ */
+void image_cache_trim(struct gab_triple gab, struct ui *gui) {
+  for (size_t i = 0; i < gui->image_cache.cap; i++) {
+    if (!d_ui_image_iexists(&gui->image_cache, i))
+      continue;
+
+    struct ui_image *img = d_ui_image_ival(&gui->image_cache, i);
+
+    if (!img->ready && img->job == nullptr && img->frame != gui->frame)
+      image_evict(gab, gui, i);
+  }
+
+  while (gui->image_bytes > IMAGE_CACHE_BYTES) {
+    size_t lru = gui->image_cache.cap;
+    uint64_t oldest = gui->frame;
+
+    for (size_t i = 0; i < gui->image_cache.cap; i++) {
+      if (!d_ui_image_iexists(&gui->image_cache, i))
+        continue;
+
+      struct ui_image *img = d_ui_image_ival(&gui->image_cache, i);
+
+      if (img->ready && img->frame < oldest)
+        lru = i, oldest = img->frame;
+    }
+
+    if (lru == gui->image_cache.cap)
+      return;
+
+    image_evict(gab, gui, lru);
+  }
+}
+
+struct ui_image *image_cache_read(struct gab_triple gab, struct ui *gui,
+                                  gab_value data) {
+  gab_assert(gab.wkid == 1, "Can only run on main thread");
+
+  struct ui_image *img = d_ui_image_read(&gui->image_cache, data);
+
+  if (img == nullptr) {
+    img = malloc(sizeof(struct ui_image));
+    gab_assert(img != nullptr, "Assume malloc can't fail");
+    *img = (struct ui_image){};
+
+    // The decode reads straight out of the binary, so keep it alive for as
+    // long as we have an entry for it.
+    gab_iref(gab, data);
+    d_ui_image_insert(&gui->image_cache, data, img);
+
+    if (gui->k != kGAB_HUI)
+      image_decode(gui, img, data);
+  }
+
+  img->frame = gui->frame;
+
+  if (img->job != nullptr)
+    image_finish(gui, img);
+
+  return img;
+}
+
+/*
+ * Stop and join the decoders, then drop every image - along with any decode
+ * they didn't get to. This has to happen before the graphics context goes.
+ */
+void image_cache_destroy(struct gab_triple gab, struct ui *gui) {
+  struct ui_decoders *d = &gui->decoders;
+
+  mtx_lock(&d->mtx);
+  d->stop = true;
+  cnd_broadcast(&d->cnd);
+  mtx_unlock(&d->mtx);
+
+  for (uint8_t i = 0; i < d->len; i++)
+    thrd_join(d->threads[i], nullptr);
+
+  d->len = 0;
+  d->head = d->tail = nullptr;
+
+  for (size_t i = 0; i < gui->image_cache.cap; i++)
+    if (d_ui_image_iexists(&gui->image_cache, i))
+      image_evict(gab, gui, i);
+
+  d_ui_image_destroy(&gui->image_cache);
+
+  mtx_destroy(&d->mtx);
+  cnd_destroy(&d->cnd);
+}
+
+/*
+ * Drop every cache, and the last app we drew. Like image_cache_destroy, this
+ * is the end of the renderer - nothing is drawn afterwards.
+ */
+void caches_destroy(struct gab_triple gab, struct ui *gui) {
+  for (size_t i = 0; i < gui->props_cache.cap; i++)
+    if (d_ui_props_iexists(&gui->props_cache, i))
+      gab_dref(gab, d_ui_props_ikey(&gui->props_cache, i));
+
+  d_ui_props_destroy(&gui->props_cache);
+
+  for (size_t i = 0; i < gui->text_cache.cap; i++) {
+    if (!d_ui_text_iexists(&gui->text_cache, i))
+      continue;
+
+    free(d_ui_text_ival(&gui->text_cache, i).chars);
+    gab_dref(gab, d_ui_text_ikey(&gui->text_cache, i));
+  }
+
+  d_ui_text_destroy(&gui->text_cache);
+
+  if (gui->last != gab_cundefined)
+    gab_dref(gab, gui->last);
+
+  gui->last = gab_cundefined;
+
+  image_cache_destroy(gab, gui);
+}
 
 [[nodiscard]]
 union gab_value_pair render_image(struct gab_triple gab, struct ui *gui,
@@ -878,17 +1412,20 @@ union gab_value_pair render_image(struct gab_triple gab, struct ui *gui,
                       "containing the image content. Found:\n\n$",
                       content);
 
-  const struct ui_image *img = image_cache_read(gab, gui, content);
+  struct ui_image *img = image_cache_read(gab, gui, content);
 
-  // Pull default w/h out of the image width/height itself.
+  // Pull default w/h out of the image width/height itself. Until the image
+  // is decoded, we draw an empty placeholder sized by its props.
 
-  gab_uint w = gui->k == kGAB_GUI ? img->as.gui.width
+  gab_uint w = !img->ready          ? 0
+               : gui->k == kGAB_GUI ? img->as.gui.width
 #if HAS_TERMBOX
                : gui->k == kGAB_TUI ? img->as.tui.pixel_width
 #endif
                                     : 0;
 
-  gab_uint h = gui->k == kGAB_GUI ? img->as.gui.height
+  gab_uint h = !img->ready          ? 0
+               : gui->k == kGAB_GUI ? img->as.gui.height
 #if HAS_TERMBOX
                : gui->k == kGAB_TUI ? img->as.tui.pixel_height
 #endif
@@ -901,7 +1438,7 @@ union gab_value_pair render_image(struct gab_triple gab, struct ui *gui,
                    .padding = parsePadding(gab, props),
                    .sizing = parseSizing(gab, props, w, h),
                },
-           .image = {.imageData = (void *)img},
+           .image = {.imageData = img->ready ? (void *)&img->as : nullptr},
        }, );
 
   return gab_union_cvalid(gab_nil);
@@ -916,16 +1453,9 @@ union gab_value_pair render_text(struct gab_triple gab, struct ui *gui,
                       "containing the text content. Found:\n\n$",
                       content);
 
-  // This leaks every time
-  uint64_t len = gab_strlen(content);
-  char *str = malloc(len + 1);
-  gab_assert(str != nullptr, "Assume malloc can't fail");
-  strcpy(str, gab_strdata(&content));
-
-  // not guaranteed to work here.
   Clay_String text = {
-      .length = len,
-      .chars = str,
+      .length = gab_strlen(content),
+      .chars = text_cache_read(gab, gui, content),
   };
 
   gab_value vsize = gab_mrecat(gab, props, "size");
@@ -979,9 +1509,11 @@ union gab_value_pair render_text(struct gab_triple gab, struct ui *gui,
   else if (valign == gab_message(gab, "center"))
     align = CLAY_TEXT_ALIGN_CENTER;
 
+  struct ui_props parsed = props_cache_read(gab, gui, props);
+
   CLAY(CLAY_IDI("", gui->n++), {
-                                   .layout = parseLayout(gab, props),
-                                   .transition = parseTransition(gab, props),
+                                   .layout = parsed.layout,
+                                   .transition = parsed.transition,
                                    .backgroundColor = packedToClayColor(vbg),
                                }) {
     CLAY_TEXT(text, CLAY_TEXT_CONFIG({
@@ -1238,6 +1770,7 @@ GAB_DYNLIB_NATIVE_FN(ui, hui_render) {
     if (res.status != gab_cundefined)
       goto err;
 
+    caches_endframe(gab, gui);
     gab_dref(gab, app);
   }
 
@@ -1258,11 +1791,13 @@ yield:
 err:
   gab_chnclose(gui->appch);
   gab_chnclose(gui->evch);
+  caches_destroy(gab, gui);
   return res;
 
 fin:
   gab_chnclose(gui->appch);
   gab_chnclose(gui->evch);
+  caches_destroy(gab, gui);
   return gab_union_cinvalid;
 }
 
@@ -1443,8 +1978,13 @@ GAB_DYNLIB_NATIVE_FN(ui, tui_render) {
       goto err;
     }
 
-    if (app == gab_ctimeout)
-      return gab_union_ctimeout(gab_cundefined);
+    if (app == gab_ctimeout) {
+      // Draw the last app again if images it was waiting on have decoded.
+      if (gui->last == gab_cundefined || !image_cache_poll(gui))
+        return gab_union_ctimeout(gab_cundefined);
+
+      app = gui->last;
+    }
 
     // Reset our id counter;
     gui->n = 0;
@@ -1481,17 +2021,20 @@ GAB_DYNLIB_NATIVE_FN(ui, tui_render) {
     Clay_Termbox_Render(cmd);
     tb_present();
 
-    gab_dref(gab, app);
+    caches_endframe(gab, gui);
+    keep_last(gab, gui, app);
   }
 
 err:
   gab_chnclose(gui->appch);
   gab_chnclose(gui->evch);
+  caches_destroy(gab, gui);
   return res;
 
 fin:
   gab_chnclose(gui->appch);
   gab_chnclose(gui->evch);
+  caches_destroy(gab, gui);
   Clay_Termbox_Close();
   return gab_union_cinvalid;
 }
@@ -1596,8 +2139,13 @@ GAB_DYNLIB_NATIVE_FN(ui, gui_render) {
       goto err;
     }
 
-    if (app == gab_ctimeout)
-      return gab_union_ctimeout(gab_cundefined);
+    if (app == gab_ctimeout) {
+      // Draw the last app again if images it was waiting on have decoded.
+      if (gui->last == gab_cundefined || !image_cache_poll(gui))
+        return gab_union_ctimeout(gab_cundefined);
+
+      app = gui->last;
+    }
 
     // Reset our id counter;
     gui->n = 0;
@@ -1654,7 +2202,8 @@ GAB_DYNLIB_NATIVE_FN(ui, gui_render) {
 
     RGFW_window_swapBuffers_OpenGL(&gui->win);
 
-    gab_dref(gab, app);
+    caches_endframe(gab, gui);
+    keep_last(gab, gui, app);
   }
 
   return gab_union_ctimeout(gab_cundefined);
@@ -1662,6 +2211,7 @@ GAB_DYNLIB_NATIVE_FN(ui, gui_render) {
 err:
   gab_chnclose(gui->appch);
   gab_chnclose(gui->evch);
+  caches_destroy(gab, gui);
   sclay_shutdown();
   RGFW_window_closePtr(&gui->win);
   return res;
@@ -1669,6 +2219,7 @@ err:
 fin:
   gab_chnclose(gui->appch);
   gab_chnclose(gui->evch);
+  caches_destroy(gab, gui);
   sclay_shutdown();
   RGFW_window_closePtr(&gui->win);
   return gab_union_cinvalid;
@@ -1800,6 +2351,11 @@ GAB_DYNLIB_NATIVE_FN(ui, run) {
   gab_value vgui = gab_gui(gab);
   struct ui *gui = gab_boxdata(vgui);
   d_ui_image_create(&gui->image_cache, 8);
+  mtx_init(&gui->decoders.mtx, mtx_plain);
+  cnd_init(&gui->decoders.cnd);
+  d_ui_props_create(&gui->props_cache, 64);
+  d_ui_text_create(&gui->text_cache, 64);
+  gui->last = gab_cundefined;
 
   if (kind == gab_message(gab, "gui")) {
     render_rec_name = "ui\\gui\\loop\\render";